@@ -0,0 +1,178 @@
+#include "MocapCapturePipeline.h"
+
+#include "HAL/Event.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/RunnableThread.h"
+#include "MocapRecorderComponent.h"
+
+namespace
+{
+    // Worker idle wait; submissions wake it immediately, this only bounds a missed wake-up.
+    constexpr uint32 MocapPipelineIdleWaitMs = 2;
+}
+
+FMocapCapturePipeline::FMocapCapturePipeline(int32 InCapacity)
+    : ReadyQueue(FMath::Max(2, InCapacity) + 1)
+    , FreeQueue(FMath::Max(2, InCapacity) + 1)
+{
+    const int32 Capacity = FMath::Max(2, InCapacity);
+
+    Packets.SetNum(Capacity);
+    for (int32 Index = 0; Index < Capacity; ++Index)
+    {
+        FreeQueue.Enqueue(Index);
+    }
+
+    WorkEvent = FPlatformProcess::GetSynchEventFromPool(false);
+    CommittedEvent = FPlatformProcess::GetSynchEventFromPool(false);
+
+    if (FPlatformProcess::SupportsMultithreading())
+    {
+        Thread = FRunnableThread::Create(this, TEXT("MocapCapturePipeline"), 0, TPri_Normal);
+    }
+}
+
+FMocapCapturePipeline::~FMocapCapturePipeline()
+{
+    if (Thread)
+    {
+        Thread->Kill(true); // Stop() + join
+        delete Thread;
+        Thread = nullptr;
+    }
+
+    // Nothing may be left half-written in a take.
+    DrainReadyQueue();
+
+    FPlatformProcess::ReturnSynchEventToPool(WorkEvent);
+    FPlatformProcess::ReturnSynchEventToPool(CommittedEvent);
+    WorkEvent = nullptr;
+    CommittedEvent = nullptr;
+}
+
+int32 FMocapCapturePipeline::AcquirePacket()
+{
+    int32 PacketIndex = INDEX_NONE;
+    if (FreeQueue.Dequeue(PacketIndex))
+    {
+        return PacketIndex;
+    }
+
+    // Backpressure: every packet is in flight. Wait for the worker rather than dropping a frame.
+    ++NumStalls;
+    const double StallStart = FPlatformTime::Seconds();
+
+    while (!FreeQueue.Dequeue(PacketIndex))
+    {
+        if (Thread)
+        {
+            WorkEvent->Trigger();
+            CommittedEvent->Wait(MocapPipelineIdleWaitMs);
+        }
+        else
+        {
+            DrainReadyQueue();
+        }
+    }
+
+    StallSeconds += FPlatformTime::Seconds() - StallStart;
+    return PacketIndex;
+}
+
+void FMocapCapturePipeline::Submit(int32 PacketIndex)
+{
+    check(Packets.IsValidIndex(PacketIndex));
+
+    ++NumSubmitted;
+    QueueDepthHighWater = FMath::Max(QueueDepthHighWater, (int32)(NumSubmitted - NumCommitted.load()));
+
+    verify(ReadyQueue.Enqueue(PacketIndex)); // cannot be full: at most Capacity packets exist
+
+    if (Thread)
+    {
+        WorkEvent->Trigger();
+    }
+    else
+    {
+        DrainReadyQueue();
+    }
+}
+
+void FMocapCapturePipeline::Flush()
+{
+    const int64 Target = NumSubmitted;
+
+    while (NumCommitted.load() < Target)
+    {
+        if (Thread)
+        {
+            WorkEvent->Trigger();
+            CommittedEvent->Wait(MocapPipelineIdleWaitMs);
+        }
+        else
+        {
+            DrainReadyQueue();
+        }
+    }
+}
+
+FMocapCapturePipelineStats FMocapCapturePipeline::GetStats() const
+{
+    FMocapCapturePipelineStats Stats;
+    Stats.Capacity = Packets.Num();
+    Stats.QueueDepthHighWater = QueueDepthHighWater;
+    Stats.NumSubmitted = NumSubmitted;
+    Stats.NumCommitted = NumCommitted.load();
+    Stats.NumDropped = NumDropped.load();
+    Stats.NumStalls = NumStalls;
+    Stats.StallSeconds = StallSeconds;
+    return Stats;
+}
+
+uint32 FMocapCapturePipeline::Run()
+{
+    while (!bStopping.load())
+    {
+        if (!DrainReadyQueue())
+        {
+            WorkEvent->Wait(MocapPipelineIdleWaitMs);
+        }
+    }
+
+    return 0;
+}
+
+void FMocapCapturePipeline::Stop()
+{
+    bStopping.store(true);
+    WorkEvent->Trigger();
+}
+
+bool FMocapCapturePipeline::DrainReadyQueue()
+{
+    bool bAny = false;
+
+    int32 PacketIndex = INDEX_NONE;
+    while (ReadyQueue.Dequeue(PacketIndex))
+    {
+        FMocapCapturePacket& Packet = Packets[PacketIndex];
+
+        if (!Packet.Recorder || !Packet.Recorder->CommitPipelinedPose(Packet))
+        {
+            NumDropped.fetch_add(1);
+        }
+        Packet.Recorder = nullptr;
+
+        FreeQueue.Enqueue(PacketIndex);
+        NumCommitted.fetch_add(1);
+        bAny = true;
+    }
+
+    if (bAny)
+    {
+        CommittedEvent->Trigger();
+    }
+
+    return bAny;
+}
@@ -4,16 +4,39 @@
 #include "Animation/AnimInstance.h"
 #include "Animation/AnimSequence.h"
 #include "AnimationRuntime.h"
+#include "Components/SkeletalMeshComponent.h"
 #include "Engine/World.h"
 #include "GameFramework/Actor.h"
+#include "MocapCapturePipeline.h"
 #include "MocapRecorderExportUtils.h"
 #include "MocapRecorderPoseUtils.h"
+#include "MocapRecorderSkeletonCache.h"
 
 // IWYU: include what you use; do not rely on transitive includes.
 
 namespace
 {  
   // unnamed namespace
+
+    /** Exact rational form of a sample rate in Hz: integer rates as N/1, NTSC rates as N*1000/1001, else millihertz. */
+    FFrameRate MakeMocapFrameRate(float Hz)
+    {
+        Hz = (Hz > 0.f) ? Hz : 60.f;
+
+        const int32 Whole = FMath::RoundToInt32(Hz);
+        if (Whole > 0 && FMath::IsNearlyEqual(Hz, (float)Whole, 1e-3f))
+        {
+            return FFrameRate(Whole, 1);
+        }
+
+        const int32 Ntsc = FMath::RoundToInt32(Hz * 1.001f);
+        if (Ntsc > 0 && FMath::IsNearlyEqual(Hz, Ntsc * 1000.f / 1001.f, 1e-3f))
+        {
+            return FFrameRate(Ntsc * 1000, 1001);
+        }
+
+        return FFrameRate(FMath::Max(1, FMath::RoundToInt32(Hz * 1000.f)), 1000);
+    }
 } 
 
 // ============================================================================
@@ -33,7 +56,6 @@ UMocapRecorderComponent::UMocapRecorderComponent()
     bIsRecording = false;
     RecordedFrameCount = 0;
     TimeAccumulator = 0.f;
-    TimeFromStart = 0.f;
         
 }
 
@@ -77,6 +99,12 @@ void UMocapRecorderComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
         W->GetTimerManager().ClearTimer(SampleTimerHandle);
     }
 
+    // The pipeline worker may still hold poses for this component.
+    if (CapturePipeline)
+    {
+        CapturePipeline->Flush();
+    }
+
     Super::EndPlay(EndPlayReason);
 }
 
@@ -114,32 +142,32 @@ void UMocapRecorderComponent::TickComponent(float DeltaTime, ELevelTick TickType
 // Recording control
 // ============================================================================
 
-UMocapRecorderComponent* UMocapRecorderComponent::CreateBakeSnapshot() const
+FMocapRecordedTake UMocapRecorderComponent::TransferRecordedTake()
 {
-    UMocapRecorderComponent* Snapshot = NewObject<UMocapRecorderComponent>(GetTransientPackage());
-
-    // Copy recorded data needed for baking
-    Snapshot->SampleRate = SampleRate;
-    Snapshot->bPreserveStartingLocation = bPreserveStartingLocation;
-    Snapshot->SessionWorldOrigin = SessionWorldOrigin;
-
-    Snapshot->RecordedSkeleton = RecordedSkeleton;
-    Snapshot->RecordedMeshAsset = RecordedMeshAsset;
-
-    Snapshot->Frames = Frames;
-    Snapshot->RecordedBoneNames = RecordedBoneNames;
-
-    Snapshot->BoneParentIndices = BoneParentIndices;
-    Snapshot->BoneSkeletonIndices = BoneSkeletonIndices;
-    Snapshot->BoneNames = BoneNames;
+    // The pipeline worker must be done with the take before it changes hands.
+    if (bIsRecording)
+    {
+        StopRecording_External();
+    }
 
-    // Ensure snapshot is not tied to the live world
-    Snapshot->TargetSkeletalMesh = nullptr;
-    Snapshot->bExternalSampling = false;
-    Snapshot->bAutoExportOnStop = false;
-    Snapshot->bIsRecording = false;
+    FMocapRecordedTake Recorded;
+    Recorded.Skeleton = RecordedSkeleton.Get();
+    Recorded.MeshAsset = RecordedMeshAsset.Get();
+    Recorded.CaptureMode = CaptureMode;
+    Recorded.SampleRate = GetRecordedFrameRate();
+    Recorded.WorldBakeBaselineRoot = WorldBakeBaselineRoot;
+    Recorded.SourceName = GetNameSafe(GetOwner());
+
+    // Topology is immutable and shared per mesh and bone mask: no copy.
+    Recorded.Topology = Topology;
+
+    // Recorded data changes owner: chunk ownership moves with the takes (no sample is copied).
+    Recorded.Take = MoveTemp(Take);
+    Recorded.RawTake = MoveTemp(RawTake);
+    Recorded.TransformFrames = MoveTemp(TransformFrames);
+    RecordedFrameCount = 0;
 
-    return Snapshot;
+    return Recorded;
 }
 
 void UMocapRecorderComponent::StartRecording()
@@ -192,10 +220,15 @@ void UMocapRecorderComponent::StartRecording()
     }
 
 
-    Frames.Reset();
+    Take.Reset(GetRecordedBoneNames().Num(), Topology ? Topology->RootIndex : 0);
+    Take.SetSampleRate(GetRecordedFrameRate());
+    Take.SetCompression(TakeCompression);
+    RawTake.Reset(GetRecordedBoneNames().Num());
+    CaptureStats = FMocapCaptureStats();
+    PipelineSampleAllocations = 0;
     RecordedFrameCount = 0;
     TimeAccumulator = 0.f;
-    TimeFromStart = 0.f;
+    LastSampleIndex = INDEX_NONE;
     bIsRecording = true;
     
 
@@ -269,7 +302,7 @@ void UMocapRecorderComponent::StartRecording_External()
     StartRecording_ExternalWithPreRoll(0);
 }
 
-void UMocapRecorderComponent::StartRecording_ExternalWithPreRoll(int32 PreRollFrames)
+void UMocapRecorderComponent::StartRecording_ExternalWithPreRoll(int64 PreRollFrames)
 {
     bExternalSampling = true;
 
@@ -303,10 +336,15 @@ void UMocapRecorderComponent::StartRecording_ExternalWithPreRoll(int32 PreRollFr
         return;
     }
 
-    Frames.Reset();
+    Take.Reset(GetRecordedBoneNames().Num(), Topology ? Topology->RootIndex : 0);
+    Take.SetSampleRate(GetRecordedFrameRate());
+    Take.SetCompression(TakeCompression);
+    RawTake.Reset(GetRecordedBoneNames().Num());
+    CaptureStats = FMocapCaptureStats();
+    PipelineSampleAllocations = 0;
     RecordedFrameCount = 0;
     TimeAccumulator = 0.f;
-    TimeFromStart = 0.f;
+    LastSampleIndex = INDEX_NONE;
 
     bIsRecording = true;
 
@@ -316,51 +354,42 @@ void UMocapRecorderComponent::StartRecording_ExternalWithPreRoll(int32 PreRollFr
     // ------------------------------------------------------------
     // Static preroll padding (align late-spawned actors to session timeline)
     // ------------------------------------------------------------
-    PreRollFrames = FMath::Max(0, PreRollFrames);
+    PreRollFrames = FMath::Max<int64>(0, PreRollFrames);
+    StartSampleIndex = PreRollFrames;
     if (PreRollFrames > 0)
     {
-        FMocapFrame StaticFrame;
-        if (CaptureCurrentPoseToFrame(StaticFrame))
+        // Sparse preroll: store the static pose once at the last preroll sample; the timeline holds it before that.
+        if (CaptureCurrentPoseToTake(PreRollFrames - 1) != INDEX_NONE)
         {
-            const float Dt = (SampleRate > 0.f) ? (1.f / SampleRate) : (1.f / 60.f);
-
-            for (int32 i = 0; i < PreRollFrames; ++i)
-            {
-                FMocapFrame& F = Frames.AddDefaulted_GetRef();
-                F.Time = TimeFromStart;
-
-                F.Translations = StaticFrame.Translations;
-                F.Rotations = StaticFrame.Rotations;
-
-#if WITH_EDITORONLY_DATA
-                F.HeadWorld = StaticFrame.HeadWorld;
-                F.TailWorld = StaticFrame.TailWorld;
-#endif
-                TimeFromStart += Dt;
-            }
+            LastSampleIndex = PreRollFrames - 1;
         }
         else
         {
-            UE_LOG(LogMocapRecorder, Warning, TEXT("preroll requested (%d) but CaptureCurrentPoseToFrame failed."), PreRollFrames);
+            UE_LOG(LogMocapRecorder, Warning, TEXT("preroll requested (%lld) but CaptureCurrentPoseToTake failed."), PreRollFrames);
         }
     }
 }
 
-void UMocapRecorderComponent::StartRecording_ExternalTransformOnly(int32 InStartSampleIndex)
+void UMocapRecorderComponent::StartRecording_ExternalTransformOnly(int64 InStartSampleIndex)
 {
     bExternalSampling = true;
     CaptureMode = EMocapCaptureMode::TransformOnly;
-    StartSampleIndex = FMath::Max(0, InStartSampleIndex);
+    StartSampleIndex = FMath::Max<int64>(0, InStartSampleIndex);
 
     if (bIsRecording)
         return;
 
     // Reset buffers
-    Frames.Reset();            // <-- we WILL use this (1-bone skeletal frames)
+    Take.Reset(1);             // <-- we WILL use this (1-bone skeletal frames)
+    Take.SetSampleRate(GetRecordedFrameRate());
+    Take.SetCompression(TakeCompression);
+    RawTake.Reset(0);          // transform-only frames are always derived
     TransformFrames.Reset();   // <-- still record full transform (including scale)
+    CaptureStats = FMocapCaptureStats();
+    PipelineSampleAllocations = 0;
     RecordedFrameCount = 0;
     TimeAccumulator = 0.f;
-    TimeFromStart = 0.f;
+    LastSampleIndex = INDEX_NONE;
 
     // Reset baseline so transform-only uses the same policy as skeletal
     bHasWorldBakeBaseline = false;
@@ -373,16 +402,7 @@ void UMocapRecorderComponent::StartRecording_ExternalTransformOnly(int32 InStart
     RecordedMeshAsset = nullptr;
 
     // Build a 1-bone "recording skeleton description" for the baker.
-    RecordedBoneNames.Reset();
-    BoneParentIndices.Reset();
-    BoneSkeletonIndices.Reset();
-    BoneNames.Reset();
-
-    RecordedBoneNames.Add(TransformOnlyRootBoneName);
-    BoneNames.Add(TransformOnlyRootBoneName);
-
-    BoneParentIndices.Add(INDEX_NONE);   // root has no parent
-    BoneSkeletonIndices.Add(0);          // single bone
+    Topology = MocapRecorderSkeletonCache::MakeSingleBone(TransformOnlyRootBoneName);
 
     if (!IsValid(RecordedSkeleton))
     {
@@ -403,6 +423,14 @@ void UMocapRecorderComponent::StopRecording_External()
     if (!bIsRecording)
         return;
 
+    // Deterministic stop: every pose submitted so far is in the take before anyone reads it.
+    if (CapturePipeline)
+    {
+        CapturePipeline->Flush();
+        CapturePipeline.Reset();
+        MergePipelineCaptureStats();
+    }
+
     bIsRecording = false;
 
    if (USkeletalMeshComponent* SkelComp = TargetSkeletalMesh)
@@ -415,7 +443,9 @@ void UMocapRecorderComponent::StopRecording_External()
    RecordedFrameCount =
        (CaptureMode == EMocapCaptureMode::TransformOnly)
        ? TransformFrames.Num()
-       : Frames.Num();
+       : GetNumRecordedFrames();
+
+   LogCaptureStats();
 
 }
 
@@ -441,9 +471,11 @@ void UMocapRecorderComponent::StopRecording()
         SkelComp->ForcedLodModel = 0;
     }
 
-    const int32 NumFrames = Frames.Num();
+    const int32 NumFrames = GetNumRecordedFrames();
     RecordedFrameCount = NumFrames;
 
+    LogCaptureStats();
+
     if (GEngine)
     {
         GEngine->AddOnScreenDebugMessage(
@@ -464,9 +496,7 @@ void UMocapRecorderComponent::StopRecording()
 
 bool UMocapRecorderComponent::BuildSkeletonInfo()
 {
-    RecordedBoneNames.Reset();
-    BoneParentIndices.Reset();
-    BoneSkeletonIndices.Reset();
+    Topology.Reset();
 
     if (!TargetSkeletalMesh)
         return false;
@@ -475,26 +505,23 @@ bool UMocapRecorderComponent::BuildSkeletonInfo()
     if (!Mesh)
         return false;
 
-    const FReferenceSkeleton& RefSkeleton = Mesh->GetRefSkeleton();
-    const int32 NumBones = RefSkeleton.GetNum();
-    if (NumBones <= 0)
+    // Shared per mesh and mask: every recorder of the same mesh and mask gets the same topology instance.
+    Topology = MocapRecorderSkeletonCache::FindOrBuild(Mesh, BoneMask);
+    if (!Topology.IsValid())
         return false;
 
-    RecordedBoneNames.Reserve(NumBones);
-    BoneParentIndices.Reserve(NumBones);
-    BoneSkeletonIndices.Reserve(NumBones);
-
-    for (int32 BoneIndex = 0; BoneIndex < NumBones; ++BoneIndex)
-    {
-        RecordedBoneNames.Add(RefSkeleton.GetBoneName(BoneIndex));
-        BoneSkeletonIndices.Add(BoneIndex);
-        BoneParentIndices.Add(RefSkeleton.GetParentIndex(BoneIndex));
-    }
-
-    UE_LOG(LogTemp, Log, TEXT("MocapRecorder: Export bones=%d (from %d), INCLUDED ALL bones"), NumBones, NumBones);
+    UE_LOG(LogTemp, Log, TEXT("MocapRecorder: Export bones=%d (from %d), %s"),
+        Topology->Num(), Topology->NumSkeletonBones,
+        Topology->IsMasked() ? TEXT("bone mask applied") : TEXT("INCLUDED ALL bones"));
     return true;
 }
 
+const TArray<FName>& UMocapRecorderComponent::GetRecordedBoneNames() const
+{
+    static const TArray<FName> Empty;
+    return Topology.IsValid() ? Topology->BoneNames : Empty;
+}
+
 // ============================================================================
 // Frame sampling – per-bone local transforms
 // ============================================================================
@@ -533,65 +560,91 @@ static FVector QuatToEuler_ZYX_Degrees(const FQuat& Q_in)
     );
 }
 
-bool UMocapRecorderComponent::CaptureCurrentPoseToFrame(FMocapFrame& OutFrame)
+int32 UMocapRecorderComponent::CaptureCurrentPoseToTake(int64 SampleIndex, bool bPoseFinalized)
+{
+    const TArray<FTransform>* CSTransforms = EvaluatePoseForCapture(bPoseFinalized);
+    if (!CSTransforms)
+        return INDEX_NONE;
+
+    // Raw capture: one bulk copy; locals are derived by FMocapRecordedTake::ResolveRawCapture at bake time.
+    if (PoseStorage == EMocapPoseStorage::RawComponentSpace)
+    {
+        const int32 RawAllocationsBefore = RawTake.GetNumAllocations();
+        const int32 RawFrameIndex = RawTake.AddFrame(*CSTransforms, TargetSkeletalMesh->GetComponentTransform(), SampleIndex);
+        CaptureStats.NumSampleAllocations += RawTake.GetNumAllocations() - RawAllocationsBefore;
+        return RawFrameIndex;
+    }
+
+    const int32 FrameIndex = ReserveTakeFrame(SampleIndex);
+    CaptureStats.NumSampleAllocations += WritePoseToTakeFrame(*CSTransforms, TargetSkeletalMesh->GetComponentTransform(), FrameIndex, CaptureScratch);
+    return FrameIndex;
+}
+
+const TArray<FTransform>* UMocapRecorderComponent::EvaluatePoseForCapture(bool bPoseFinalized)
 {
     if (!TargetSkeletalMesh)
     {
         TargetSkeletalMesh = GetOwner() ? GetOwner()->FindComponentByClass<USkeletalMeshComponent>() : nullptr;
         if (!TargetSkeletalMesh)
-            return false;
+            return nullptr;
     }
 
     USkeletalMesh* Mesh = TargetSkeletalMesh->GetSkeletalMeshAsset();
     if (!Mesh)
-        return false;
+        return nullptr;
 
     const FReferenceSkeleton& RefSkel = Mesh->GetRefSkeleton();
     const int32 NumSkelBones = RefSkel.GetNum();
     if (NumSkelBones <= 0)
-        return false;
-
-    const int32 NumExportBones = RecordedBoneNames.Num();
-    if (NumExportBones != NumSkelBones ||
-        BoneSkeletonIndices.Num() != NumExportBones ||
-        BoneParentIndices.Num() != NumExportBones)
+        return nullptr;
+
+    const FMocapSkeletonTopology* Topo = Topology.Get();
+    const int32 NumExportBones = Topo ? Topo->Num() : 0;
+    if (!Topo || Topo->NumSkeletonBones != NumSkelBones ||
+        Topo->SkeletonIndices.Num() != NumExportBones ||
+        Topo->ParentIndices.Num() != NumExportBones ||
+        Take.GetNumBones() != NumExportBones)
     {
-        UE_LOG(LogTemp, Error, TEXT("MocapRecorder: CaptureCurrentPoseToFrame export arrays not aligned. Rebuild skeleton info."));
-        return false;
+        UE_LOG(LogTemp, Error, TEXT("MocapRecorder: CaptureCurrentPoseToTake export arrays not aligned. Rebuild skeleton info."));
+        return nullptr;
     }
 
-    // Force final pose evaluation
-    TargetSkeletalMesh->TickAnimation(0.f, false);
-    TargetSkeletalMesh->RefreshBoneTransforms();
-
-    const TArray<FTransform>& CSTransforms = TargetSkeletalMesh->GetComponentSpaceTransforms();
-    if (CSTransforms.Num() != NumSkelBones)
+    // Reuse the pose the mesh already finalized this frame; only force an evaluation when it is stale.
+    // Inside the finalize callback the pose is final by definition, whatever PoseEvaluation says.
+    if (bPoseFinalized || IsFinalizedPoseCurrent())
     {
-        UE_LOG(LogTemp, Error, TEXT("MocapRecorder: CSTransforms mismatch: got=%d expected=%d"),
-            CSTransforms.Num(), NumSkelBones);
-        return false;
+        ++CaptureStats.NumFinalizedPoseReads;
     }
+    else
+    {
+        TargetSkeletalMesh->TickAnimation(0.f, false);
+        TargetSkeletalMesh->RefreshBoneTransforms();
+        ++CaptureStats.NumForcedEvaluations;
+    }
+    LastPoseCaptureFrame = GFrameCounter;
 
-    const FTransform ComponentToWorld = TargetSkeletalMesh->GetComponentTransform();
-
-    // WORLD transforms per skeleton bone
-    TArray<FTransform> WorldBySkel;
-    WorldBySkel.SetNum(NumSkelBones);
-    for (int32 SkelIdx = 0; SkelIdx < NumSkelBones; ++SkelIdx)
+    const TArray<FTransform>& MeshTransforms = TargetSkeletalMesh->GetComponentSpaceTransforms();
+    if (MeshTransforms.Num() != NumSkelBones)
     {
-        WorldBySkel[SkelIdx] = CSTransforms[SkelIdx] * ComponentToWorld;
+        UE_LOG(LogTemp, Error, TEXT("MocapRecorder: CSTransforms mismatch: got=%d expected=%d"),
+            MeshTransforms.Num(), NumSkelBones);
+        return nullptr;
     }
 
-    // Root skeleton index (bone with no parent)
-    int32 RootSkelIdx = 0;
-    for (int32 i = 0; i < NumSkelBones; ++i)
+    // Masked: everything downstream (takes, packets, snapshots, raw storage) sees only the recorded bones.
+    if (Topo->IsMasked())
     {
-        if (RefSkel.GetParentIndex(i) == INDEX_NONE)
+        if (MaskedPose.Max() < NumExportBones)
+        {
+            ++CaptureStats.NumSampleAllocations;
+        }
+        MaskedPose.SetNumUninitialized(NumExportBones);
+        for (int32 BoneIdx = 0; BoneIdx < NumExportBones; ++BoneIdx)
         {
-            RootSkelIdx = i;
-            break;
+            MaskedPose[BoneIdx] = MeshTransforms[Topo->SkeletonIndices[BoneIdx]];
         }
     }
+    const TArray<FTransform>& CSTransforms = Topo->IsMasked() ? MaskedPose : MeshTransforms;
 
     // Establish baseline ONCE.
 // Policy:
@@ -605,77 +658,43 @@ bool UMocapRecorderComponent::CaptureCurrentPoseToFrame(FMocapFrame& OutFrame)
         }
         else
         {
-            WorldBakeBaselineRoot = WorldBySkel[RootSkelIdx]; // actor-start baseline
+            // Root bone (no parent), precomputed per topology
+            WorldBakeBaselineRoot = CSTransforms[Topo->RootIndex] * TargetSkeletalMesh->GetComponentTransform(); // actor-start baseline
         }
 
         bHasWorldBakeBaseline = true;
     }
 
-    const FTransform InvBaseline = WorldBakeBaselineRoot.Inverse();
-
-    // Rebased world transforms (CORRECT ORDER: InvBaseline * World)
-    TArray<FTransform> WorldRelBySkel;
-    WorldRelBySkel.SetNum(NumSkelBones);
-    for (int32 SkelIdx = 0; SkelIdx < NumSkelBones; ++SkelIdx)
+    // First sample of the take: its root position becomes the take's double-precision translation origin,
+    // so the float root samples stay small however far from the world origin the actor is.
+    if (LastSampleIndex == INDEX_NONE)
     {
-        WorldRelBySkel[SkelIdx] = InvBaseline * WorldBySkel[SkelIdx];
+        const FTransform RootRel = WorldBakeBaselineRoot.Inverse() * (CSTransforms[Topo->RootIndex] * TargetSkeletalMesh->GetComponentTransform());
+        Take.SetTranslationOrigin(RootRel.GetTranslation());
     }
 
-    // Parent-relative locals (safe)
-    TArray<FTransform> LocalRelBySkel;
-    LocalRelBySkel.SetNum(NumSkelBones);
-    for (int32 SkelIdx = 0; SkelIdx < NumSkelBones; ++SkelIdx)
-    {
-        const int32 Parent = RefSkel.GetParentIndex(SkelIdx);
-        if (Parent == INDEX_NONE)
-        {
-            LocalRelBySkel[SkelIdx] = WorldRelBySkel[SkelIdx];
-        }
-        else
-        {
-            LocalRelBySkel[SkelIdx] = WorldRelBySkel[SkelIdx].GetRelativeTransform(WorldRelBySkel[Parent]);
-        }
-    }
-
-
-
-    OutFrame.Translations.SetNum(NumExportBones);
-    OutFrame.Rotations.SetNum(NumExportBones);
-
-#if WITH_EDITORONLY_DATA
-    OutFrame.HeadWorld.SetNum(NumExportBones);
-    OutFrame.TailWorld.SetNum(NumExportBones);
-#endif
-
-    for (int32 BoneIdx = 0; BoneIdx < NumExportBones; ++BoneIdx)
-    {
-        const int32 SkelIdx = BoneIdx;
-
-        const FTransform& Local = LocalRelBySkel[SkelIdx];
-        OutFrame.Translations[BoneIdx] = Local.GetTranslation();
-        OutFrame.Rotations[BoneIdx] = Local.GetRotation().GetNormalized();
-
-#if WITH_EDITORONLY_DATA
-        const FVector Head = WorldRelBySkel[SkelIdx].GetTranslation(); // session-relative world (not absolute world)
-        OutFrame.HeadWorld[BoneIdx] = Head;
-
-        int32 FirstChild = INDEX_NONE;
-        for (int32 j = 0; j < NumSkelBones; ++j)
-        {
-            if (RefSkel.GetParentIndex(j) == SkelIdx)
-            {
-                FirstChild = j;
-                break;
-            }
-        }
+    return &CSTransforms;
+}
 
-        OutFrame.TailWorld[BoneIdx] = (FirstChild != INDEX_NONE)
-            ? WorldRelBySkel[FirstChild].GetTranslation()
-            : Head;
-#endif
-    }
+int32 UMocapRecorderComponent::ReserveTakeFrame(int64 SampleIndex)
+{
+    const int32 TakeAllocationsBefore = Take.GetNumAllocations();
+    const int32 FrameIndex = Take.AddFrameUninitialized(SampleIndex);
+    CaptureStats.NumSampleAllocations += Take.GetNumAllocations() - TakeAllocationsBefore;
+    return FrameIndex;
+}
 
-    return true;
+int32 UMocapRecorderComponent::WritePoseToTakeFrame(TConstArrayView<FTransform> CSTransforms, const FTransform& ComponentToWorld, int32 FrameIndex, FMocapLocalPoseScratch& Scratch)
+{
+    // CSTransforms is in topology order (the recorded bones only when masked), like the take.
+    // Channel promotion and chunk encoding acquire take chunks inside the write: count those too.
+    const FMocapSkeletonTopology* Topo = Topology.Get();
+    const int32 TakeAllocationsBefore = Take.GetNumAllocations();
+    const int32 NumScratchAllocations = MocapRecorderPoseUtils::WriteSessionLocalsToTake(
+        *Topo, WorldBakeBaselineRoot.Inverse(), CSTransforms, ComponentToWorld, Take, FrameIndex, Scratch) ? 1 : 0;
+    const int32 NumTakeAllocations = Take.GetNumAllocations() - TakeAllocationsBefore;
+
+    return NumScratchAllocations + NumTakeAllocations;
 }
 
 void UMocapRecorderComponent::SampleFrame()
@@ -683,13 +702,16 @@ void UMocapRecorderComponent::SampleFrame()
     if (!bIsRecording)
         return;
 
+    CaptureSample(LastSampleIndex + 1);
+}
+
+bool UMocapRecorderComponent::CaptureSample(int64 SampleIndex, bool bPoseFinalized)
+{
     if (CaptureMode == EMocapCaptureMode::TransformOnly)
     {
         AActor* Owner = GetOwner();
         if (!Owner)
-            return;
-
-        const float Dt = (SampleRate > 0.f) ? (1.f / SampleRate) : (1.f / 60.f);
+            return false;
 
         const FTransform WorldXf = Owner->GetActorTransform();
 
@@ -712,82 +734,314 @@ void UMocapRecorderComponent::SampleFrame()
 
         const FTransform InvBaseline = WorldBakeBaselineRoot.Inverse();
 
-        // Session-relative world (same convention as skeletal CaptureCurrentPoseToFrame):
+        // Session-relative world (same convention as skeletal CaptureCurrentPoseToTake):
         // Rel = InvBaseline * World
         const FTransform RelXf = InvBaseline * WorldXf;
 
         // 1) Record full transform (includes scale) for transform-only bookkeeping
+        const int32 TransformFramesMaxBefore = TransformFrames.Max();
         FMocapTransformFrame& TF = TransformFrames.AddDefaulted_GetRef();
-        TF.Time = TimeFromStart;
         TF.World = RelXf;
+        if (TransformFrames.Max() != TransformFramesMaxBefore)
+        {
+            ++CaptureStats.NumSampleAllocations;
+        }
 
         // 2) ALSO record as a 1-bone skeletal frame so it bakes to UAnimSequence
-        FMocapFrame& Frame = Frames.AddDefaulted_GetRef();
-        Frame.Time = TimeFromStart;
+        if (LastSampleIndex == INDEX_NONE)
+        {
+            Take.SetTranslationOrigin(RelXf.GetLocation());
+        }
 
-        Frame.Translations.SetNum(1);
-        Frame.Rotations.SetNum(1);
+        const int32 TakeAllocationsBefore = Take.GetNumAllocations();
+        const int32 FrameIndex = Take.AddFrameUninitialized(SampleIndex);
+        Take.SetBoneSample(FrameIndex, 0, RelXf.GetLocation(), RelXf.GetRotation().GetNormalized());
+        CaptureStats.NumSampleAllocations += Take.GetNumAllocations() - TakeAllocationsBefore;
 
-        Frame.Translations[0] = RelXf.GetLocation();
-        Frame.Rotations[0] = RelXf.GetRotation().GetNormalized();
+        ++CaptureStats.NumSamples;
+        LastSampleIndex = SampleIndex;
+        return true;
+    }
 
-#if WITH_EDITORONLY_DATA
-        Frame.HeadWorld.SetNum(1);
-        Frame.TailWorld.SetNum(1);
-        Frame.HeadWorld[0] = RelXf.GetLocation();
-        Frame.TailWorld[0] = RelXf.GetLocation();
-#endif
+    // Pipelined: only evaluation + a pose copy happen here; the worker converts and appends.
+    // Raw capture is already just a copy, so it never goes through the pipeline.
+    if (CapturePipeline && PoseStorage == EMocapPoseStorage::Derived)
+    {
+        if (!SubmitPoseToPipeline(SampleIndex, bPoseFinalized))
+            return false;
+    }
+    // Skeletal path: validation, evaluation and local-space conversion all happen inside
+    // CaptureCurrentPoseToTake, which writes straight into the take.
+    else if (CaptureCurrentPoseToTake(SampleIndex, bPoseFinalized) == INDEX_NONE)
+    {
+        return false;
+    }
+
+    ++CaptureStats.NumSamples;
+    LastSampleIndex = SampleIndex;
+    return true;
+}
 
-        TimeFromStart += Dt;
+void UMocapRecorderComponent::SampleFrameAtSessionIndex(int64 SessionSampleIndex, bool bPoseFinalized)
+{
+    // LastSampleIndex only advances once the capture is done, so a nested call would pass the index check.
+    if (bCapturing || !bIsRecording || SessionSampleIndex <= LastSampleIndex)
         return;
+
+    TGuardValue<bool> CapturingGuard(bCapturing, true);
+
+    // A hitch needs no padding: the timeline records the gap and the skipped samples hold the previous frame.
+    CaptureSample(SessionSampleIndex, bPoseFinalized);
+}
+
+bool UMocapRecorderComponent::SampleFrame_Snapshot(int64 SessionSampleIndex)
+{
+    if (SessionSampleIndex == INDEX_NONE)
+    {
+        SessionSampleIndex = LastSampleIndex + 1;
     }
 
-    if (!TargetSkeletalMesh)
+    if (!bIsRecording || SessionSampleIndex <= LastSampleIndex)
+        return false;
+
+    // Transform-only capture is a single actor transform: not worth deferring.
+    // Pipelined and raw recorders already defer conversion (pipeline worker / bake).
+    if (CaptureMode == EMocapCaptureMode::TransformOnly || CapturePipeline || PoseStorage == EMocapPoseStorage::RawComponentSpace)
     {
-        TargetSkeletalMesh = GetOwner() ? GetOwner()->FindComponentByClass<USkeletalMeshComponent>() : nullptr;
-        if (!TargetSkeletalMesh)
-            return;
+        CaptureSample(SessionSampleIndex);
+        return false;
     }
 
-    USkeletalMesh* Mesh = TargetSkeletalMesh->GetSkeletalMeshAsset();
-    if (!Mesh)
-        return;
+    checkSlow(PendingSnapshot.FrameIndex == INDEX_NONE);
 
-    const FReferenceSkeleton& RefSkel = Mesh->GetRefSkeleton();
-    const int32 NumSkelBones = RefSkel.GetNum();
-    if (NumSkelBones <= 0)
-        return;
+    const TArray<FTransform>* CSTransforms = EvaluatePoseForCapture();
+    if (!CSTransforms)
+        return false;
 
-    const int32 NumExportBones = RecordedBoneNames.Num();
-    if (NumExportBones != NumSkelBones ||
-        BoneSkeletonIndices.Num() != NumExportBones ||
-        BoneParentIndices.Num() != NumExportBones)
+    // Copy the pose now: the mesh may re-evaluate before the commit runs.
+    if (PendingSnapshot.ComponentSpaceTransforms.Max() < CSTransforms->Num())
     {
-        UE_LOG(LogTemp, Error, TEXT("MocapRecorder: SampleFrame export arrays not aligned to full skeleton. Rebuild skeleton info."));
+        ++CaptureStats.NumSampleAllocations;
+    }
+    PendingSnapshot.ComponentSpaceTransforms.Reset(CSTransforms->Num());
+    PendingSnapshot.ComponentSpaceTransforms.Append(*CSTransforms);
+    PendingSnapshot.ComponentToWorld = TargetSkeletalMesh->GetComponentTransform();
+
+    // Only the frame slot and its timeline entry are reserved here. The commit may still promote constant channels
+    // and encode completed chunks on a worker; those chunks come from the thread-safe session pool.
+    PendingSnapshot.FrameIndex = ReserveTakeFrame(SessionSampleIndex);
+
+    ++CaptureStats.NumSamples;
+    LastSampleIndex = SessionSampleIndex;
+    return true;
+}
+
+void UMocapRecorderComponent::SampleFrame_CommitSnapshot()
+{
+    if (PendingSnapshot.FrameIndex == INDEX_NONE)
         return;
+
+    CaptureStats.NumSampleAllocations += WritePoseToTakeFrame(
+        PendingSnapshot.ComponentSpaceTransforms, PendingSnapshot.ComponentToWorld, PendingSnapshot.FrameIndex, CaptureScratch);
+    PendingSnapshot.FrameIndex = INDEX_NONE;
+}
+
+void UMocapRecorderComponent::SetCapturePipeline(TSharedPtr<FMocapCapturePipeline> InPipeline)
+{
+    // Detaching hands the take back to the game thread: drain what is still in flight first.
+    if (CapturePipeline && CapturePipeline != InPipeline)
+    {
+        CapturePipeline->Flush();
+        MergePipelineCaptureStats();
     }
 
-    FMocapFrame Captured;
-    if (!CaptureCurrentPoseToFrame(Captured))
+    CapturePipeline = MoveTemp(InPipeline);
+}
+
+bool UMocapRecorderComponent::SubmitPoseToPipeline(int64 SampleIndex, bool bPoseFinalized)
+{
+    const TArray<FTransform>* CSTransforms = EvaluatePoseForCapture(bPoseFinalized);
+    if (!CSTransforms)
+        return false;
+
+    const int32 PacketIndex = CapturePipeline->AcquirePacket();
+    FMocapCapturePacket& Packet = CapturePipeline->GetPacket(PacketIndex);
+
+    Packet.Recorder = this;
+    Packet.SampleIndex = SampleIndex;
+    Packet.ComponentSpaceTransforms.Reset(CSTransforms->Num());
+    Packet.ComponentSpaceTransforms.Append(*CSTransforms);
+    Packet.ComponentToWorld = TargetSkeletalMesh->GetComponentTransform();
+
+    CapturePipeline->Submit(PacketIndex);
+    return true;
+}
+
+bool UMocapRecorderComponent::CommitPipelinedPose(const FMocapCapturePacket& Packet)
+{
+    // Topology is immutable and only swapped on the game thread before recording starts.
+    const FMocapSkeletonTopology* Topo = Topology.Get();
+    if (!Topo || Topo->Num() != Packet.ComponentSpaceTransforms.Num() || Take.GetNumBones() != Topo->Num())
+        return false;
+
+    // CaptureStats belongs to the game thread: count into the worker's own counter instead of ReserveTakeFrame's.
+    const int32 TakeAllocationsBefore = Take.GetNumAllocations();
+    const int32 FrameIndex = Take.AddFrameUninitialized(Packet.SampleIndex);
+    PipelineSampleAllocations += Take.GetNumAllocations() - TakeAllocationsBefore;
+    PipelineSampleAllocations += WritePoseToTakeFrame(
+        Packet.ComponentSpaceTransforms, Packet.ComponentToWorld, FrameIndex, CaptureScratch);
+    return true;
+}
+
+void UMocapRecorderComponent::MergePipelineCaptureStats()
+{
+    CaptureStats.NumSampleAllocations += PipelineSampleAllocations;
+    PipelineSampleAllocations = 0;
+}
+
+void UMocapRecorderComponent::SetTakeChunkPool(TSharedPtr<FMocapTakeChunkPool> InPool)
+{
+    if (bIsRecording)
         return;
 
-    FMocapFrame& Frame = Frames.AddDefaulted_GetRef();
-    Frame.Time = TimeFromStart;
-    Frame.Translations = MoveTemp(Captured.Translations);
-    Frame.Rotations = MoveTemp(Captured.Rotations);
+    Take.SetChunkPool(InPool);
+    RawTake.SetChunkPool(MoveTemp(InPool));
+}
+
+int32 UMocapRecorderComponent::GetNumRecordedFrames() const
+{
+    return RawTake.IsEmpty() ? Take.Num() : RawTake.Num();
+}
+
+FFrameRate UMocapRecorderComponent::GetRecordedFrameRate() const
+{
+    return MakeMocapFrameRate(SampleRate);
+}
 
-#if WITH_EDITORONLY_DATA
-    Frame.HeadWorld = MoveTemp(Captured.HeadWorld);
-    Frame.TailWorld = MoveTemp(Captured.TailWorld);
-#endif
+bool UMocapRecorderComponent::ComputeHeadTailPositions(
+    int32 FirstFrame,
+    int32 NumFrames,
+    TArray<FVector>& OutHeads,
+    TArray<FVector>& OutTails,
+    bool bAbsoluteWorld) const
+{
+    OutHeads.Reset();
+    OutTails.Reset();
 
-    TimeFromStart += (SampleRate > 0.f) ? (1.f / SampleRate) : (1.f / 60.f);
+    const FMocapSkeletonTopology* Topo = Topology.Get();
+    const int32 NumBones = Take.GetNumBones();
+    if (!Topo || Topo->Num() != NumBones || NumBones <= 0)
+        return false;
+
+    FirstFrame = FMath::Clamp(FirstFrame, 0, Take.Num());
+    NumFrames = FMath::Clamp(NumFrames, 0, Take.Num() - FirstFrame);
+
+    // Multi-bone skeletons rebuild the pose through the recorded mesh hierarchy (unrecorded bones at the reference pose).
+    const FReferenceSkeleton* RefSkel = RecordedMeshAsset ? &RecordedMeshAsset->GetRefSkeleton() : nullptr;
+    const int32 NumSkelBones = Topo->NumSkeletonBones;
+    if (NumSkelBones > 1 && (!RefSkel || RefSkel->GetNum() != NumSkelBones))
+    {
+        UE_LOG(LogMocapRecorder, Warning, TEXT("MocapRecorder: ComputeHeadTailPositions needs the recorded mesh (%s)."),
+            *GetNameSafe(GetOwner()));
+        return false;
+    }
+
+    OutHeads.SetNumUninitialized(NumFrames * NumBones);
+    OutTails.SetNumUninitialized(NumFrames * NumBones);
+
+    // Root locals are already session-relative, so the rebuilt component space is the session-relative pose.
+    const FTransform& SpaceToOutput = bAbsoluteWorld ? WorldBakeBaselineRoot : FTransform::Identity;
+
+    TArray<FTransform> LocalBySkel;
+    TArray<FTransform> SessionBySkel;
+    if (RefSkel && Topo->IsMasked())
+    {
+        LocalBySkel = RefSkel->GetRefBonePose();
+    }
+    else
+    {
+        LocalBySkel.SetNumUninitialized(NumSkelBones);
+    }
+
+    for (int32 i = 0; i < NumFrames; ++i)
+    {
+        const int32 FrameIndex = FirstFrame + i;
+
+        for (int32 BoneIdx = 0; BoneIdx < NumBones; ++BoneIdx)
+        {
+            LocalBySkel[Topo->SkeletonIndices[BoneIdx]] =
+                FTransform(Take.GetRotation(BoneIdx, FrameIndex), Take.GetTranslation(BoneIdx, FrameIndex));
+        }
+
+        if (RefSkel)
+        {
+            MocapRecorderPoseUtils::BuildComponentSpaceFromLocalPose(*RefSkel, LocalBySkel, SessionBySkel);
+        }
+        else
+        {
+            SessionBySkel = LocalBySkel; // single-bone (transform-only) take
+        }
+
+        FVector* Heads = OutHeads.GetData() + i * NumBones;
+        FVector* Tails = OutTails.GetData() + i * NumBones;
+
+        for (int32 BoneIdx = 0; BoneIdx < NumBones; ++BoneIdx)
+        {
+            const int32 SkelIdx = Topo->SkeletonIndices[BoneIdx];
+            const int32 FirstChild = Topo->FirstChildIndices[BoneIdx];
+
+            Heads[BoneIdx] = SpaceToOutput.TransformPosition(SessionBySkel[SkelIdx].GetTranslation());
+            Tails[BoneIdx] = (FirstChild != INDEX_NONE)
+                ? SpaceToOutput.TransformPosition(SessionBySkel[Topo->SkeletonIndices[FirstChild]].GetTranslation())
+                : Heads[BoneIdx];
+        }
+    }
+
+    return true;
+}
+
+const FMocapTake& UMocapRecorderComponent::GetRecordedFrames() const
+{
+    return Take;
+}
+
+bool UMocapRecorderComponent::IsFinalizedPoseCurrent() const
+{
+    if (PoseEvaluation != EMocapPoseEvaluation::ReuseFinalizedPose || !TargetSkeletalMesh)
+        return false;
+
+    // Parallel evaluation still writing the pose: not final yet.
+    if (TargetSkeletalMesh->IsRunningParallelEvaluation())
+        return false;
+
+    // Mesh has not ticked its pose this game frame (e.g. first sample right after StartRecording).
+    if (!TargetSkeletalMesh->PoseTickedThisFrame())
+        return false;
 
+    // Game frame has not advanced since the last capture (timer catch-up): treat as stale.
+    return LastPoseCaptureFrame != GFrameCounter;
 }
 
-const TArray<FMocapFrame>& UMocapRecorderComponent::GetRecordedFrames() const
+void UMocapRecorderComponent::LogCaptureStats() const
 {
-    return Frames;
+    UE_LOG(LogMocapRecorder, Log,
+        TEXT("MocapRecorder: %s capture stats Samples=%lld SampleAllocations=%lld (%.4f/sample) FinalizedPoseReads=%lld ForcedEvaluations=%lld TakeBytes=%llu RawBytes=%llu ConstantChannels=%d/%d FirstSample=%lld UniformTimeline=%d EncodedChunks=%d OverBudgetChunks=%d MaxTranslationError=%.4fcm MaxRotationError=%.4fdeg"),
+        *GetNameSafe(GetOwner()),
+        CaptureStats.NumSamples,
+        CaptureStats.NumSampleAllocations,
+        CaptureStats.GetAllocationsPerSample(),
+        CaptureStats.NumFinalizedPoseReads,
+        CaptureStats.NumForcedEvaluations,
+        (uint64)Take.GetAllocatedSize(),
+        (uint64)RawTake.GetAllocatedSize(),
+        Take.GetNumConstantChannels(),
+        Take.GetNumBones() * 2,
+        RawTake.IsEmpty() ? Take.GetTimeline().GetFirstSampleIndex() : RawTake.GetTimeline().GetFirstSampleIndex(),
+        (int32)(RawTake.IsEmpty() ? Take.GetTimeline().IsUniform() : RawTake.GetTimeline().IsUniform()),
+        Take.GetCompressionStats().NumEncodedChunks,
+        Take.GetCompressionStats().NumOverBudgetChunks,
+        Take.GetCompressionStats().MaxTranslationError,
+        Take.GetCompressionStats().MaxRotationErrorDegrees);
 }
 
 void UMocapRecorderComponent::OverrideRecordedSkeleton(USkeleton* InSkeleton)
@@ -1,6 +1,16 @@
 #include "MocapRecorderPoseUtils.h"
 
+#include "Async/ParallelFor.h"
+#include "Async/TaskGraphInterfaces.h"
 #include "ReferenceSkeleton.h"
+#include "Math/VectorRegister.h"
+#include "MocapRecorderTypes.h"
+
+namespace
+{
+    // Raw-take derivation: smallest frame range worth handing to a worker.
+    constexpr int32 MocapRawResolveMinFramesPerTask = 32;
+}
 
 namespace MocapRecorderPoseUtils
 {
@@ -33,4 +43,136 @@ namespace MocapRecorderPoseUtils
             }
         }
     }
+
+    void ComputeParentRelativeLocals(
+        TConstArrayView<FTransform> ComponentBySkel,
+        TConstArrayView<int32> ParentBySkel,
+        TArrayView<FVector> OutLocalTranslations,
+        TArrayView<FQuat> OutLocalRotations)
+    {
+        const int32 Num = ComponentBySkel.Num();
+        check(ParentBySkel.Num() == Num && OutLocalTranslations.Num() == Num && OutLocalRotations.Num() == Num);
+
+        for (int32 i = 0; i < Num; ++i)
+        {
+            const int32 Parent = ParentBySkel[i];
+            if (Parent == INDEX_NONE)
+                continue;
+
+            const FTransform& Child = ComponentBySkel[i];
+            const FTransform& ParentXf = ComponentBySkel[Parent];
+
+            // Mirrored parents need the matrix path; keep the exact scalar result for them.
+            const FVector ParentScale = ParentXf.GetScale3D();
+            if (ParentScale.X < 0.0 || ParentScale.Y < 0.0 || ParentScale.Z < 0.0)
+            {
+                const FTransform Local = Child.GetRelativeTransform(ParentXf);
+                OutLocalTranslations[i] = Local.GetTranslation();
+                OutLocalRotations[i] = Local.GetRotation().GetNormalized();
+                continue;
+            }
+
+            // Local = Child * Parent^-1:
+            //   R = Rp^-1 * Rc
+            //   T = (Rp^-1 * (Tc - Tp)) / Sp
+            const auto InvParentRot = VectorQuaternionInverse(ParentXf.GetRotationRegister());
+            const auto LocalRot = VectorNormalizeQuaternion(
+                VectorQuaternionMultiply2(InvParentRot, Child.GetRotationRegister()));
+
+            const auto Delta = VectorSubtract(Child.GetTranslationRegister(), ParentXf.GetTranslationRegister());
+            const FVector InvParentScale = FTransform::GetSafeScaleReciprocal(ParentScale);
+            const auto LocalTranslation = VectorMultiply(
+                VectorQuaternionRotateVector(InvParentRot, Delta),
+                VectorLoadFloat3_W0(&InvParentScale.X));
+
+            VectorStore(LocalRot, &OutLocalRotations[i].X);
+            VectorStoreFloat3(LocalTranslation, &OutLocalTranslations[i].X);
+        }
+    }
+
+    bool WriteSessionLocalsToTake(
+        const FMocapSkeletonTopology& Topology,
+        const FTransform& InvBaseline,
+        TConstArrayView<FTransform> ComponentPose,
+        const FTransform& ComponentToWorld,
+        FMocapTake& Take,
+        int32 FrameIndex,
+        FMocapLocalPoseScratch& Scratch)
+    {
+        const int32 NumBones = Topology.Num();
+        const int32 RootIdx = Topology.RootIndex;
+        check(ComponentPose.Num() == NumBones);
+
+        bool bGrewScratch = false;
+        if (Scratch.LocalTranslations.Num() != NumBones)
+        {
+            Scratch.LocalTranslations.SetNumUninitialized(NumBones);
+            Scratch.LocalRotations.SetNumUninitialized(NumBones);
+            bGrewScratch = true;
+        }
+
+        // Parented bones: true parent-relative locals from component space, independent of the baseline.
+        ComputeParentRelativeLocals(ComponentPose, Topology.ParentIndices, Scratch.LocalTranslations, Scratch.LocalRotations);
+
+        // Root: rebased world transform (CORRECT ORDER: InvBaseline * World).
+        const FTransform RootRel = InvBaseline * (ComponentPose[RootIdx] * ComponentToWorld);
+        Scratch.LocalTranslations[RootIdx] = RootRel.GetTranslation();
+        Scratch.LocalRotations[RootIdx] = RootRel.GetRotation().GetNormalized();
+
+        for (int32 BoneIdx = 0; BoneIdx < NumBones; ++BoneIdx)
+        {
+            Take.SetBoneSample(FrameIndex, BoneIdx, Scratch.LocalTranslations[BoneIdx], Scratch.LocalRotations[BoneIdx]);
+        }
+
+        return bGrewScratch;
+    }
+
+    int32 ResolveRawTake(
+        const FMocapSkeletonTopology& Topology,
+        const FTransform& WorldBakeBaselineRoot,
+        const FFrameRate& SampleRate,
+        const FMocapRawTake& RawTake,
+        FMocapTake& Take)
+    {
+        const int32 NumFrames = RawTake.Num();
+
+        // Frames are allocated up front (with the raw timeline) so workers only ever write their own slots.
+        // The origin was taken from the first captured pose.
+        const FVector TranslationOrigin = Take.GetTranslationOrigin();
+        Take.Reset(Topology.Num(), Topology.RootIndex);
+        Take.SetTranslationOrigin(TranslationOrigin);
+        Take.SetSampleRate(SampleRate);
+        Take.Reserve(NumFrames);
+        for (int32 FrameIndex = 0; FrameIndex < NumFrames; ++FrameIndex)
+        {
+            Take.AddFrameUninitialized(RawTake.GetTimeline().GetSampleIndex(FrameIndex));
+        }
+
+        // Out-of-order writes: constant-channel detection runs once afterwards instead of online.
+        Take.PromoteAllChannels();
+
+        const int32 NumTasks = FMath::Clamp(
+            NumFrames / MocapRawResolveMinFramesPerTask,
+            1,
+            FTaskGraphInterface::Get().GetNumWorkerThreads() + 1);
+
+        const FTransform InvBaseline = WorldBakeBaselineRoot.Inverse();
+        ParallelFor(NumTasks, [&Topology, &InvBaseline, &RawTake, &Take, NumFrames, NumTasks](int32 TaskIndex)
+        {
+            const int32 Begin = (int32)((int64)NumFrames * TaskIndex / NumTasks);
+            const int32 End = (int32)((int64)NumFrames * (TaskIndex + 1) / NumTasks);
+
+            FMocapLocalPoseScratch Scratch;
+            for (int32 FrameIndex = Begin; FrameIndex < End; ++FrameIndex)
+            {
+                WriteSessionLocalsToTake(Topology, InvBaseline,
+                    RawTake.GetComponentSpace(FrameIndex), RawTake.GetComponentToWorld(FrameIndex), Take, FrameIndex, Scratch);
+            }
+        });
+
+        Take.CompactConstantChannels();
+        Take.EncodeCompleteChunks();
+
+        return NumTasks;
+    }
 }
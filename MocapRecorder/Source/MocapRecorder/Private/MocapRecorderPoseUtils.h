@@ -3,6 +3,11 @@
 #include "CoreMinimal.h"
 
 struct FReferenceSkeleton;
+struct FFrameRate;
+struct FMocapSkeletonTopology;
+struct FMocapTake;
+struct FMocapRawTake;
+struct FMocapLocalPoseScratch;
 
 namespace MocapRecorderPoseUtils
 {
@@ -12,4 +17,38 @@ namespace MocapRecorderPoseUtils
         const FReferenceSkeleton& RefSkel,
         const TArray<FTransform>& LocalBySkel,
         TArray<FTransform>& OutComponentBySkel);
+
+    // Parent-relative local translation/rotation for every bone that has a parent, straight from the
+    // component-space pose (one bone at a time in VectorRegister math; rotations normalized). Parentless bones are left untouched:
+    // the caller fills them from the world/baseline path. All arrays are skeleton bone index order.
+    void ComputeParentRelativeLocals(
+        TConstArrayView<FTransform> ComponentBySkel,
+        TConstArrayView<int32> ParentBySkel,
+        TArrayView<FVector> OutLocalTranslations,
+        TArrayView<FQuat> OutLocalRotations);
+
+    // Session-relative locals for one topology-order pose, written into FrameIndex of Take: parented bones
+    // relative to their parent, the root rebased (InvBaseline * root world). Scratch keeps the locals afterwards.
+    // Only the root depends on the baseline. Parented locals are the component-space ones; the previous path took
+    // them between rebased world poses, which conjugated them by the baseline (InvBaseline * Local * Baseline)
+    // and matched only for an identity baseline.
+    // Grows Scratch as needed; returns true if it did.
+    bool WriteSessionLocalsToTake(
+        const FMocapSkeletonTopology& Topology,
+        const FTransform& InvBaseline,
+        TConstArrayView<FTransform> ComponentPose,
+        const FTransform& ComponentToWorld,
+        FMocapTake& Take,
+        int32 FrameIndex,
+        FMocapLocalPoseScratch& Scratch);
+
+    // Derives Take from RawTake's component-space poses (parallel over frames), keeping Take's translation
+    // origin. Frames are filled out of order, so constant channels are compacted and chunks encoded once
+    // afterwards. Returns the number of tasks used.
+    int32 ResolveRawTake(
+        const FMocapSkeletonTopology& Topology,
+        const FTransform& WorldBakeBaselineRoot,
+        const FFrameRate& SampleRate,
+        const FMocapRawTake& RawTake,
+        FMocapTake& Take);
 }
@@ -0,0 +1,250 @@
+#include "MocapRecorderSkeletonCache.h"
+
+#include "MocapRecorderModule.h" // for LogMocapRecorder
+#include "MocapRecorderTypes.h"
+#include "Engine/SkeletalMesh.h"
+#include "ReferenceSkeleton.h"
+#include "UObject/ObjectKey.h"
+#include "UObject/WeakObjectPtr.h"
+
+namespace
+{
+    struct FCachedTopology
+    {
+        TWeakObjectPtr<const USkeletalMesh> Mesh;
+        TSharedPtr<const FMocapSkeletonTopology> Topology;
+
+        // Masked subsets of Topology built so far (a handful per mesh at most).
+        TArray<TPair<FMocapBoneMask, TSharedPtr<const FMocapSkeletonTopology>>> MaskedTopologies;
+    };
+
+    TMap<TObjectKey<USkeletalMesh>, FCachedTopology> GTopologyByMesh;
+
+    // A reimported mesh keeps its key but may change bones; verify before reuse.
+    bool MatchesRefSkeleton(const FMocapSkeletonTopology& Topology, const FReferenceSkeleton& RefSkel)
+    {
+        const int32 Num = RefSkel.GetNum();
+        if (Topology.Num() != Num)
+            return false;
+
+        for (int32 i = 0; i < Num; ++i)
+        {
+            if (Topology.BoneNames[i] != RefSkel.GetBoneName(i) ||
+                Topology.ParentIndices[i] != RefSkel.GetParentIndex(i))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    TSharedPtr<const FMocapSkeletonTopology> Build(const FReferenceSkeleton& RefSkel)
+    {
+        const int32 Num = RefSkel.GetNum();
+
+        TSharedPtr<FMocapSkeletonTopology> Topology = MakeShared<FMocapSkeletonTopology>();
+        Topology->ParentIndices.SetNumUninitialized(Num);
+        Topology->FirstChildIndices.Init(INDEX_NONE, Num);
+        Topology->BoneNames.SetNum(Num);
+        Topology->SkeletonIndices.SetNumUninitialized(Num);
+        Topology->NumSkeletonBones = Num;
+
+        for (int32 i = 0; i < Num; ++i)
+        {
+            const int32 Parent = RefSkel.GetParentIndex(i);
+
+            Topology->ParentIndices[i] = Parent;
+            Topology->BoneNames[i] = RefSkel.GetBoneName(i);
+            Topology->SkeletonIndices[i] = i;
+
+            if (Parent == INDEX_NONE)
+            {
+                if (Topology->RootIndex == INDEX_NONE)
+                {
+                    Topology->RootIndex = i;
+                }
+            }
+            else if (Topology->FirstChildIndices[Parent] == INDEX_NONE)
+            {
+                // Parents precede children, so the lowest child index is seen first.
+                Topology->FirstChildIndices[Parent] = i;
+            }
+        }
+
+        if (Topology->RootIndex == INDEX_NONE)
+        {
+            Topology->RootIndex = 0;
+        }
+
+        return Topology;
+    }
+
+    // Subset of Full selected by Mask, closed under parents so it is a hierarchy of its own.
+    // Listed names the skeleton does not have are ignored with a warning (built once per mesh and mask).
+    TSharedPtr<const FMocapSkeletonTopology> BuildMasked(const FMocapSkeletonTopology& Full, const FMocapBoneMask& Mask, const USkeletalMesh& Mesh)
+    {
+        const int32 Num = Full.Num();
+        TBitArray<> Keep(false, Num);
+
+        int32 NumListedFound = 0;
+        for (const FName& Bone : Mask.Bones)
+        {
+            if (Full.BoneNames.Contains(Bone))
+            {
+                ++NumListedFound;
+            }
+            else
+            {
+                UE_LOG(LogMocapRecorder, Warning, TEXT("MocapRecorder: bone mask lists '%s', which %s does not have; ignored."),
+                    *Bone.ToString(), *GetNameSafe(&Mesh));
+            }
+        }
+
+        const bool bListSelectsBones = Mask.Mode == EMocapBoneMaskMode::Include || Mask.Mode == EMocapBoneMaskMode::BranchRoots;
+        if (bListSelectsBones && NumListedFound == 0)
+        {
+            UE_LOG(LogMocapRecorder, Warning, TEXT("MocapRecorder: no bone of the mask exists on %s; only the root will be recorded."),
+                *GetNameSafe(&Mesh));
+        }
+
+        switch (Mask.Mode)
+        {
+        case EMocapBoneMaskMode::Include:
+            for (int32 i = 0; i < Num; ++i)
+            {
+                Keep[i] = Mask.Bones.Contains(Full.BoneNames[i]);
+            }
+            break;
+
+        case EMocapBoneMaskMode::BranchRoots:
+            // Parents precede children, so a branch is marked in one forward pass.
+            for (int32 i = 0; i < Num; ++i)
+            {
+                const int32 Parent = Full.ParentIndices[i];
+                Keep[i] = Mask.Bones.Contains(Full.BoneNames[i]) || (Parent != INDEX_NONE && Keep[Parent]);
+            }
+            break;
+
+        case EMocapBoneMaskMode::Exclude:
+        {
+            TBitArray<> Excluded(false, Num);
+            for (int32 i = 0; i < Num; ++i)
+            {
+                const int32 Parent = Full.ParentIndices[i];
+                Excluded[i] = Mask.Bones.Contains(Full.BoneNames[i]) || (Parent != INDEX_NONE && Excluded[Parent]);
+                Keep[i] = !Excluded[i];
+            }
+            break;
+        }
+
+        case EMocapBoneMaskMode::RootOnly:
+        case EMocapBoneMaskMode::All:
+        default:
+            break;
+        }
+
+        // The root carries the actor's motion; ancestors keep every recorded local relative to a recorded parent.
+        Keep[Full.RootIndex] = true;
+        for (int32 i = Num - 1; i >= 0; --i)
+        {
+            const int32 Parent = Full.ParentIndices[i];
+            if (Keep[i] && Parent != INDEX_NONE)
+            {
+                Keep[Parent] = true;
+            }
+        }
+
+        TArray<int32> TopologyIndexBySkel;
+        TopologyIndexBySkel.Init(INDEX_NONE, Num);
+
+        TSharedPtr<FMocapSkeletonTopology> Topology = MakeShared<FMocapSkeletonTopology>();
+        Topology->NumSkeletonBones = Full.NumSkeletonBones;
+
+        for (int32 i = 0; i < Num; ++i)
+        {
+            if (!Keep[i])
+                continue;
+
+            const int32 Index = Topology->BoneNames.Num();
+            const int32 FullParent = Full.ParentIndices[i];
+            const int32 Parent = FullParent != INDEX_NONE ? TopologyIndexBySkel[FullParent] : INDEX_NONE;
+
+            TopologyIndexBySkel[i] = Index;
+            Topology->BoneNames.Add(Full.BoneNames[i]);
+            Topology->SkeletonIndices.Add(Full.SkeletonIndices[i]);
+            Topology->ParentIndices.Add(Parent);
+            Topology->FirstChildIndices.Add(INDEX_NONE);
+
+            if (Parent != INDEX_NONE && Topology->FirstChildIndices[Parent] == INDEX_NONE)
+            {
+                Topology->FirstChildIndices[Parent] = Index;
+            }
+        }
+
+        Topology->RootIndex = TopologyIndexBySkel[Full.RootIndex];
+        return Topology;
+    }
+}
+
+namespace MocapRecorderSkeletonCache
+{
+    TSharedPtr<const FMocapSkeletonTopology> FindOrBuild(const USkeletalMesh* Mesh, const FMocapBoneMask& Mask)
+    {
+        check(IsInGameThread());
+
+        if (!Mesh)
+            return nullptr;
+
+        const FReferenceSkeleton& RefSkel = Mesh->GetRefSkeleton();
+        if (RefSkel.GetNum() <= 0)
+            return nullptr;
+
+        const TObjectKey<USkeletalMesh> Key(Mesh);
+        FCachedTopology* Cached = GTopologyByMesh.Find(Key);
+        if (!Cached || Cached->Mesh.Get() != Mesh || !MatchesRefSkeleton(*Cached->Topology, RefSkel))
+        {
+            // Drop entries whose mesh has been garbage collected before adding a new one.
+            for (auto It = GTopologyByMesh.CreateIterator(); It; ++It)
+            {
+                if (!It.Value().Mesh.IsValid())
+                {
+                    It.RemoveCurrent();
+                }
+            }
+
+            Cached = &GTopologyByMesh.FindOrAdd(Key);
+            Cached->Mesh = Mesh;
+            Cached->Topology = Build(RefSkel);
+            Cached->MaskedTopologies.Reset();
+        }
+
+        if (Mask.IsAll())
+        {
+            return Cached->Topology;
+        }
+
+        for (const TPair<FMocapBoneMask, TSharedPtr<const FMocapSkeletonTopology>>& Masked : Cached->MaskedTopologies)
+        {
+            if (Masked.Key == Mask)
+            {
+                return Masked.Value;
+            }
+        }
+
+        TSharedPtr<const FMocapSkeletonTopology> Topology = BuildMasked(*Cached->Topology, Mask, *Mesh);
+        Cached->MaskedTopologies.Emplace(Mask, Topology);
+        return Topology;
+    }
+
+    TSharedPtr<const FMocapSkeletonTopology> MakeSingleBone(FName BoneName)
+    {
+        TSharedPtr<FMocapSkeletonTopology> Topology = MakeShared<FMocapSkeletonTopology>();
+        Topology->RootIndex = 0;
+        Topology->ParentIndices.Add(INDEX_NONE);   // root has no parent
+        Topology->FirstChildIndices.Add(INDEX_NONE);
+        Topology->BoneNames.Add(BoneName);
+        Topology->SkeletonIndices.Add(0);          // single bone
+        Topology->NumSkeletonBones = 1;
+        return Topology;
+    }
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+class USkeletalMesh;
+struct FMocapBoneMask;
+struct FMocapSkeletonTopology;
+
+namespace MocapRecorderSkeletonCache
+{
+    // Returns the shared topology for Mesh restricted to Mask, building it on first use.
+    // Every recorder of the same mesh and mask receives the same instance. Game thread only.
+    TSharedPtr<const FMocapSkeletonTopology> FindOrBuild(const USkeletalMesh* Mesh, const FMocapBoneMask& Mask);
+
+    // Builds a standalone single-bone topology (transform-only recordings).
+    TSharedPtr<const FMocapSkeletonTopology> MakeSingleBone(FName BoneName);
+}
@@ -0,0 +1,953 @@
+#include "MocapRecorderTypes.h"
+
+#include "Algo/BinarySearch.h"
+#include "Async/ParallelFor.h"
+#include "HAL/PlatformTime.h"
+#include "MocapRecorderModule.h"
+#include "MocapRecorderPoseUtils.h"
+#include "MocapTakeChunkPool.h"
+
+namespace
+{
+    // Smallest-three: the three components other than the largest lie in [-1/sqrt(2), 1/sqrt(2)].
+    constexpr float MocapQuatComponentRange = UE_INV_SQRT_2;
+    constexpr uint32 MocapQuatComponentMax = (1u << 15) - 1;
+
+    // Range-quantized translation axes.
+    constexpr uint32 MocapTranslationAxisMax = MAX_uint16;
+
+    /**
+     * Packs a unit quaternion into 48 bits: index of the largest component (2 bits), its sign (1 bit),
+     * and the other three components at 15 bits each.
+     */
+    void EncodeMocapQuat(const FQuat4f& Rotation, uint16* Out)
+    {
+        const FQuat4f Q = Rotation.GetNormalized();
+        const float Components[4] = { Q.X, Q.Y, Q.Z, Q.W };
+
+        uint32 Largest = 0;
+        for (uint32 Index = 1; Index < 4; ++Index)
+        {
+            if (FMath::Abs(Components[Index]) > FMath::Abs(Components[Largest]))
+            {
+                Largest = Index;
+            }
+        }
+
+        // The sign is kept (rather than folding q and -q) so decoded keys never flip hemisphere between frames.
+        uint64 Bits = Largest | ((Components[Largest] < 0.f ? 1ull : 0ull) << 2);
+        uint32 Shift = 3;
+        for (uint32 Index = 0; Index < 4; ++Index)
+        {
+            if (Index == Largest)
+                continue;
+
+            const float Normalized = (Components[Index] + MocapQuatComponentRange) / (2.f * MocapQuatComponentRange);
+            const uint64 Quantized = (uint64)FMath::Clamp(FMath::RoundToInt(Normalized * MocapQuatComponentMax), 0, (int32)MocapQuatComponentMax);
+            Bits |= Quantized << Shift;
+            Shift += 15;
+        }
+
+        Out[0] = (uint16)Bits;
+        Out[1] = (uint16)(Bits >> 16);
+        Out[2] = (uint16)(Bits >> 32);
+    }
+
+    FQuat4f DecodeMocapQuat(const uint16* In)
+    {
+        const uint64 Bits = (uint64)In[0] | ((uint64)In[1] << 16) | ((uint64)In[2] << 32);
+        const uint32 Largest = (uint32)(Bits & 3);
+
+        float Components[4];
+        float SumSquares = 0.f;
+        uint32 Shift = 3;
+        for (uint32 Index = 0; Index < 4; ++Index)
+        {
+            if (Index == Largest)
+                continue;
+
+            const float Normalized = (float)((Bits >> Shift) & MocapQuatComponentMax) / MocapQuatComponentMax;
+            Components[Index] = Normalized * (2.f * MocapQuatComponentRange) - MocapQuatComponentRange;
+            SumSquares += Components[Index] * Components[Index];
+            Shift += 15;
+        }
+
+        const float LargestValue = FMath::Sqrt(FMath::Max(0.f, 1.f - SumSquares));
+        Components[Largest] = (Bits & 4) ? -LargestValue : LargestValue;
+
+        return FQuat4f(Components[0], Components[1], Components[2], Components[3]);
+    }
+
+    /** Angle (degrees) between two rotations, computed from the component distance so it stays precise near zero. */
+    double GetMocapRotationErrorDegrees(const FQuat4f& A, const FQuat4f& B)
+    {
+        const FQuat QA = FQuat(A).GetNormalized();
+        const FQuat QB = FQuat(B).GetNormalized();
+        const double DistSame = (QA - QB).Size();
+        const double DistFlipped = (QA + QB).Size();
+        return FMath::RadiansToDegrees(4.0 * FMath::Asin(FMath::Min(1.0, 0.5 * FMath::Min(DistSame, DistFlipped))));
+    }
+}
+
+// ------------------------------------------------------------
+// FMocapTake
+// ------------------------------------------------------------
+
+template <typename SampleType>
+void FMocapTake::AddChunk(TMocapTakeChannel<SampleType>& Channel)
+{
+    FMocapTakeChunk& Chunk = Channel.Chunks.AddDefaulted_GetRef();
+    Chunk.Data = FMocapTakeChunkPool::AllocateChunk(ChunkPool.Get(), FramesPerChunk * sizeof(SampleType));
+    ++NumAllocations;
+}
+
+template <typename SampleType>
+void FMocapTake::WriteSample(TMocapTakeChannel<SampleType>& Channel, int32 FrameIndex, const SampleType& Value)
+{
+    FMocapTakeChunk& Chunk = Channel.Chunks[FrameIndex / FramesPerChunk];
+    if (Chunk.bEncoded)
+    {
+        // Only after a frame is removed and rewritten.
+        DecodeChunk<SampleType>(Chunk);
+    }
+    static_cast<SampleType*>(Chunk.Data)[FrameIndex % FramesPerChunk] = Value;
+}
+
+template <typename SampleType>
+void FMocapTake::EncodeCompletedChunks(TMocapTakeChannel<SampleType>& Channel, int32 FrameIndex, bool bPromoted)
+{
+    if (!Compression.bEnabled || bDeferEncoding)
+        return;
+
+    // A channel promoted by this sample has complete chunks before it (filled with its constant).
+    const int32 ChunkIndex = FrameIndex / FramesPerChunk;
+    for (int32 Earlier = bPromoted ? 0 : ChunkIndex; Earlier < ChunkIndex; ++Earlier)
+    {
+        EncodeChunk(Channel, Earlier, CompressionStats, NumAllocations);
+    }
+
+    if ((FrameIndex + 1) % FramesPerChunk == 0)
+    {
+        EncodeChunk(Channel, ChunkIndex, CompressionStats, NumAllocations);
+    }
+}
+
+template <typename SampleType>
+void FMocapTake::CommitEncodedChunk(FMocapTakeChunk& Chunk, void* Encoded, FMocapTakeCompressionStats& Stats) const
+{
+    FMocapTakeChunkPool::ReleaseChunk(ChunkPool.Get(), Chunk.Data, FramesPerChunk * sizeof(SampleType));
+    Chunk.Data = Encoded;
+    Chunk.bEncoded = true;
+    ++Stats.NumEncodedChunks;
+}
+
+template <typename SampleType>
+void FMocapTake::EncodeChannelCompleteChunks(TMocapTakeChannel<SampleType>& Channel, FMocapTakeCompressionStats& Stats, int32& InOutNumAllocations) const
+{
+    const int32 NumComplete = NumFrames / FramesPerChunk;
+    for (int32 ChunkIndex = 0; ChunkIndex < NumComplete && !Channel.IsConstant(); ++ChunkIndex)
+    {
+        if (!Channel.Chunks[ChunkIndex].bEncoded)
+        {
+            EncodeChunk(Channel, ChunkIndex, Stats, InOutNumAllocations);
+        }
+    }
+}
+
+template <typename SampleType>
+void FMocapTake::DecodeChunk(FMocapTakeChunk& Chunk)
+{
+    check(Chunk.bEncoded);
+
+    SampleType* Decoded = static_cast<SampleType*>(FMocapTakeChunkPool::AllocateChunk(ChunkPool.Get(), FramesPerChunk * sizeof(SampleType)));
+    ++NumAllocations;
+    for (int32 Sample = 0; Sample < FramesPerChunk; ++Sample)
+    {
+        DecodeSample(Chunk, Sample, Decoded[Sample]);
+    }
+
+    FMocapTakeChunkPool::ReleaseChunk(ChunkPool.Get(), Chunk.Data, EncodedChunkBytes);
+    Chunk.Data = Decoded;
+    Chunk.bEncoded = false;
+    --CompressionStats.NumEncodedChunks;
+}
+
+template <typename SampleType>
+void FMocapTake::PromoteChannel(TMocapTakeChannel<SampleType>& Channel)
+{
+    if (!Channel.IsConstant())
+        return;
+
+    const int32 NumChunks = FMath::DivideAndRoundUp(NumFrames, FramesPerChunk);
+    for (int32 ChunkIndex = 0; ChunkIndex < NumChunks; ++ChunkIndex)
+    {
+        AddChunk(Channel);
+
+        SampleType* Chunk = static_cast<SampleType*>(Channel.Chunks.Last().Data);
+        for (int32 Sample = 0; Sample < FramesPerChunk; ++Sample)
+        {
+            Chunk[Sample] = Channel.Constant;
+        }
+    }
+}
+
+template <typename SampleType>
+void FMocapTake::ReleaseChannel(TMocapTakeChannel<SampleType>& Channel)
+{
+    for (const FMocapTakeChunk& Chunk : Channel.Chunks)
+    {
+        FMocapTakeChunkPool::ReleaseChunk(ChunkPool.Get(), Chunk.Data, GetChunkBytes<SampleType>(Chunk));
+    }
+    Channel.Chunks.Reset();
+}
+
+template <typename SampleType>
+void FMocapTake::CompactChannel(TMocapTakeChannel<SampleType>& Channel)
+{
+    if (Channel.IsConstant() || NumFrames == 0)
+        return;
+
+    const SampleType First = GetSample(Channel, 0);
+    for (int32 Frame = 1; Frame < NumFrames; ++Frame)
+    {
+        if (!IsWithinTolerance(GetSample(Channel, Frame), First))
+            return;
+    }
+
+    ReleaseChannel(Channel);
+    Channel.Constant = First;
+}
+
+template <typename SampleType>
+void FMocapTake::CopyChannel(TMocapTakeChannel<SampleType>& Channel, const TMocapTakeChannel<SampleType>& OtherChannel)
+{
+    Channel.Constant = OtherChannel.Constant;
+    Channel.Chunks.Reset(OtherChannel.Chunks.Num());
+
+    for (const FMocapTakeChunk& OtherChunk : OtherChannel.Chunks)
+    {
+        const SIZE_T NumBytes = GetChunkBytes<SampleType>(OtherChunk);
+
+        FMocapTakeChunk& Chunk = Channel.Chunks.Add_GetRef(OtherChunk);
+        Chunk.Data = FMocapTakeChunkPool::AllocateChunk(ChunkPool.Get(), NumBytes);
+        FMemory::Memcpy(Chunk.Data, OtherChunk.Data, NumBytes);
+        ++NumAllocations;
+    }
+}
+
+FMocapTake::FMocapTake(const FMocapTake& Other)
+{
+    CopyFrom(Other);
+}
+
+FMocapTake::FMocapTake(FMocapTake&& Other)
+{
+    *this = MoveTemp(Other);
+}
+
+FMocapTake& FMocapTake::operator=(const FMocapTake& Other)
+{
+    if (this != &Other)
+    {
+        ReleaseChunks();
+        CopyFrom(Other);
+    }
+    return *this;
+}
+
+FMocapTake& FMocapTake::operator=(FMocapTake&& Other)
+{
+    if (this != &Other)
+    {
+        ReleaseChunks();
+
+        NumBones = Other.NumBones;
+        NumFrames = Other.NumFrames;
+        NumAllocations = Other.NumAllocations;
+        RootBoneIndex = Other.RootBoneIndex;
+        TranslationOrigin = Other.TranslationOrigin;
+        TranslationToleranceSquared = Other.TranslationToleranceSquared;
+        RotationToleranceSquared = Other.RotationToleranceSquared;
+        SampleRate = Other.SampleRate;
+        Timeline = MoveTemp(Other.Timeline);
+        Compression = Other.Compression;
+        CompressionStats = Other.CompressionStats;
+        bDeferEncoding = Other.bDeferEncoding;
+        ChunkPool = MoveTemp(Other.ChunkPool);
+        Translations = MoveTemp(Other.Translations);
+        Rotations = MoveTemp(Other.Rotations);
+
+        Other.NumBones = 0;
+        Other.NumFrames = 0;
+        Other.CompressionStats = FMocapTakeCompressionStats();
+        Other.Timeline.Reset();
+        Other.Translations.Reset();
+        Other.Rotations.Reset();
+    }
+    return *this;
+}
+
+FMocapTake::~FMocapTake()
+{
+    ReleaseChunks();
+}
+
+void FMocapTake::SetChunkPool(TSharedPtr<FMocapTakeChunkPool> InPool)
+{
+    if (InPool != ChunkPool)
+    {
+        ReleaseChunks();
+        ChunkPool = MoveTemp(InPool);
+    }
+}
+
+void FMocapTake::Reset(int32 InNumBones, int32 InRootBoneIndex)
+{
+    ReleaseChunks();
+
+    NumBones = FMath::Max(0, InNumBones);
+    RootBoneIndex = InRootBoneIndex;
+    TranslationOrigin = FVector::ZeroVector;
+    CompressionStats = FMocapTakeCompressionStats();
+    bDeferEncoding = false;
+
+    Translations.SetNum(NumBones);
+    Rotations.SetNum(NumBones);
+    for (int32 Bone = 0; Bone < NumBones; ++Bone)
+    {
+        Translations[Bone].Constant = FVector3f::ZeroVector;
+        Rotations[Bone].Constant = FQuat4f::Identity;
+    }
+}
+
+void FMocapTake::Empty()
+{
+    ReleaseChunks();
+}
+
+void FMocapTake::Reserve(int32 InFrameCapacity)
+{
+    const int32 NumChunks = FMath::DivideAndRoundUp(FMath::Max(0, InFrameCapacity), FramesPerChunk);
+
+    for (TMocapTakeChannel<FVector3f>& Channel : Translations)
+    {
+        Channel.Chunks.Reserve(NumChunks);
+    }
+    for (TMocapTakeChannel<FQuat4f>& Channel : Rotations)
+    {
+        Channel.Chunks.Reserve(NumChunks);
+    }
+}
+
+void FMocapTake::SetConstantTolerances(float InTranslationTolerance, float InRotationToleranceRadians)
+{
+    TranslationToleranceSquared = FMath::Square(FMath::Max(0.f, InTranslationTolerance));
+    RotationToleranceSquared = FMath::Square(0.5f * FMath::Max(0.f, InRotationToleranceRadians));
+}
+
+int32 FMocapTake::AddFrameUninitialized(int64 SampleIndex)
+{
+    // Full tracks gain a chunk every FramesPerChunk frames; recorded samples never move.
+    if (NumFrames % FramesPerChunk == 0)
+    {
+        for (TMocapTakeChannel<FVector3f>& Channel : Translations)
+        {
+            if (!Channel.IsConstant())
+            {
+                AddChunk(Channel);
+            }
+        }
+        for (TMocapTakeChannel<FQuat4f>& Channel : Rotations)
+        {
+            if (!Channel.IsConstant())
+            {
+                AddChunk(Channel);
+            }
+        }
+    }
+
+    verify(Timeline.AddFrame(SampleIndex) == NumFrames);
+    return NumFrames++;
+}
+
+void FMocapTake::RemoveLastFrame()
+{
+    if (NumFrames == 0)
+    {
+        return;
+    }
+
+    Timeline.RemoveLastFrame();
+    --NumFrames;
+
+    // Keep exactly the chunks the remaining frames need.
+    if (NumFrames % FramesPerChunk == 0)
+    {
+        for (TMocapTakeChannel<FVector3f>& Channel : Translations)
+        {
+            if (!Channel.IsConstant())
+            {
+                const FMocapTakeChunk Chunk = Channel.Chunks.Pop();
+                FMocapTakeChunkPool::ReleaseChunk(ChunkPool.Get(), Chunk.Data, GetChunkBytes<FVector3f>(Chunk));
+            }
+        }
+        for (TMocapTakeChannel<FQuat4f>& Channel : Rotations)
+        {
+            if (!Channel.IsConstant())
+            {
+                const FMocapTakeChunk Chunk = Channel.Chunks.Pop();
+                FMocapTakeChunkPool::ReleaseChunk(ChunkPool.Get(), Chunk.Data, GetChunkBytes<FQuat4f>(Chunk));
+            }
+        }
+    }
+}
+
+void FMocapTake::SetBoneSample(int32 FrameIndex, int32 BoneIndex, const FVector& Translation, const FQuat& Rotation)
+{
+    checkSlow(BoneIndex >= 0 && BoneIndex < NumBones && FrameIndex >= 0 && FrameIndex < NumFrames);
+
+    const FVector3f T(BoneIndex == RootBoneIndex ? Translation - TranslationOrigin : Translation);
+    const FQuat4f Q(Rotation);
+
+    TMocapTakeChannel<FVector3f>& TChannel = Translations[BoneIndex];
+    bool bPromotedT = false;
+    if (TChannel.IsConstant())
+    {
+        if (FrameIndex == 0)
+        {
+            TChannel.Constant = T;
+        }
+        else if (!IsWithinTolerance(T, TChannel.Constant))
+        {
+            PromoteChannel(TChannel);
+            bPromotedT = true;
+        }
+    }
+    if (!TChannel.IsConstant())
+    {
+        WriteSample(TChannel, FrameIndex, T);
+        EncodeCompletedChunks(TChannel, FrameIndex, bPromotedT);
+    }
+
+    TMocapTakeChannel<FQuat4f>& RChannel = Rotations[BoneIndex];
+    bool bPromotedR = false;
+    if (RChannel.IsConstant())
+    {
+        if (FrameIndex == 0)
+        {
+            RChannel.Constant = Q;
+        }
+        else if (!IsWithinTolerance(Q, RChannel.Constant))
+        {
+            PromoteChannel(RChannel);
+            bPromotedR = true;
+        }
+    }
+    if (!RChannel.IsConstant())
+    {
+        WriteSample(RChannel, FrameIndex, Q);
+        EncodeCompletedChunks(RChannel, FrameIndex, bPromotedR);
+    }
+}
+
+void FMocapTake::PromoteAllChannels()
+{
+    bDeferEncoding = true;
+
+    for (TMocapTakeChannel<FVector3f>& Channel : Translations)
+    {
+        PromoteChannel(Channel);
+    }
+    for (TMocapTakeChannel<FQuat4f>& Channel : Rotations)
+    {
+        PromoteChannel(Channel);
+    }
+}
+
+void FMocapTake::CompactConstantChannels()
+{
+    for (TMocapTakeChannel<FVector3f>& Channel : Translations)
+    {
+        CompactChannel(Channel);
+    }
+    for (TMocapTakeChannel<FQuat4f>& Channel : Rotations)
+    {
+        CompactChannel(Channel);
+    }
+}
+
+void FMocapTake::EncodeCompleteChunks()
+{
+    bDeferEncoding = false;
+    if (!Compression.bEnabled)
+        return;
+
+    // One task per channel (translations, then rotations). The chunk pool is thread-safe; counters are per
+    // channel and merged afterwards.
+    const int32 NumChannels = NumBones * 2;
+    TArray<FMocapTakeCompressionStats> ChannelStats;
+    TArray<int32> ChannelAllocations;
+    ChannelStats.SetNum(NumChannels);
+    ChannelAllocations.SetNumZeroed(NumChannels);
+
+    ParallelFor(NumChannels, [this, &ChannelStats, &ChannelAllocations](int32 ChannelIndex)
+    {
+        if (ChannelIndex < NumBones)
+        {
+            EncodeChannelCompleteChunks(Translations[ChannelIndex], ChannelStats[ChannelIndex], ChannelAllocations[ChannelIndex]);
+        }
+        else
+        {
+            EncodeChannelCompleteChunks(Rotations[ChannelIndex - NumBones], ChannelStats[ChannelIndex], ChannelAllocations[ChannelIndex]);
+        }
+    });
+
+    for (int32 ChannelIndex = 0; ChannelIndex < NumChannels; ++ChannelIndex)
+    {
+        CompressionStats.Accumulate(ChannelStats[ChannelIndex]);
+        NumAllocations += ChannelAllocations[ChannelIndex];
+    }
+}
+
+void FMocapTake::SetCompression(const FMocapTakeCompression& InCompression)
+{
+    Compression = InCompression;
+    Compression.TranslationErrorBudget = FMath::Max(0.f, Compression.TranslationErrorBudget);
+    Compression.RotationErrorBudgetDegrees = FMath::Max(0.f, Compression.RotationErrorBudgetDegrees);
+}
+
+void FMocapTake::EncodeChunk(TMocapTakeChannel<FVector3f>& Channel, int32 ChunkIndex, FMocapTakeCompressionStats& Stats, int32& InOutNumAllocations) const
+{
+    FMocapTakeChunk& Chunk = Channel.Chunks[ChunkIndex];
+    const FVector3f* Samples = static_cast<const FVector3f*>(Chunk.Data);
+
+    // Per-axis bounds of this chunk: the quantization range adapts to how far the bone moved over these frames only.
+    FVector3f Min = Samples[0];
+    FVector3f Max = Samples[0];
+    for (int32 Sample = 1; Sample < FramesPerChunk; ++Sample)
+    {
+        Min = Min.ComponentMin(Samples[Sample]);
+        Max = Max.ComponentMax(Samples[Sample]);
+    }
+
+    FMocapTakeChunk Encoded;
+    Encoded.RangeMin = Min;
+    Encoded.RangeStep = (Max - Min) / (float)MocapTranslationAxisMax;
+    Encoded.bEncoded = true;
+
+    uint16* Data = static_cast<uint16*>(FMocapTakeChunkPool::AllocateChunk(ChunkPool.Get(), EncodedChunkBytes));
+    ++InOutNumAllocations;
+    Encoded.Data = Data;
+
+    float MaxError = 0.f;
+    for (int32 Sample = 0; Sample < FramesPerChunk; ++Sample)
+    {
+        for (int32 Axis = 0; Axis < 3; ++Axis)
+        {
+            const float Step = Encoded.RangeStep[Axis];
+            Data[Sample * 3 + Axis] = Step > 0.f
+                ? (uint16)FMath::Clamp(FMath::RoundToInt((Samples[Sample][Axis] - Min[Axis]) / Step), 0, (int32)MocapTranslationAxisMax)
+                : 0;
+        }
+
+        FVector3f Decoded;
+        DecodeSample(Encoded, Sample, Decoded);
+        MaxError = FMath::Max(MaxError, FVector3f::Dist(Decoded, Samples[Sample]));
+    }
+
+    if (MaxError > Compression.TranslationErrorBudget)
+    {
+        FMocapTakeChunkPool::ReleaseChunk(ChunkPool.Get(), Data, EncodedChunkBytes);
+        ++Stats.NumOverBudgetChunks;
+        return;
+    }
+
+    Chunk.RangeMin = Encoded.RangeMin;
+    Chunk.RangeStep = Encoded.RangeStep;
+    CommitEncodedChunk<FVector3f>(Chunk, Data, Stats);
+    Stats.MaxTranslationError = FMath::Max(Stats.MaxTranslationError, MaxError);
+}
+
+void FMocapTake::EncodeChunk(TMocapTakeChannel<FQuat4f>& Channel, int32 ChunkIndex, FMocapTakeCompressionStats& Stats, int32& InOutNumAllocations) const
+{
+    FMocapTakeChunk& Chunk = Channel.Chunks[ChunkIndex];
+    const FQuat4f* Samples = static_cast<const FQuat4f*>(Chunk.Data);
+
+    uint16* Data = static_cast<uint16*>(FMocapTakeChunkPool::AllocateChunk(ChunkPool.Get(), EncodedChunkBytes));
+    ++InOutNumAllocations;
+
+    double MaxErrorDegrees = 0.0;
+    for (int32 Sample = 0; Sample < FramesPerChunk; ++Sample)
+    {
+        EncodeMocapQuat(Samples[Sample], Data + Sample * 3);
+        MaxErrorDegrees = FMath::Max(MaxErrorDegrees, GetMocapRotationErrorDegrees(DecodeMocapQuat(Data + Sample * 3), Samples[Sample]));
+    }
+
+    if (MaxErrorDegrees > Compression.RotationErrorBudgetDegrees)
+    {
+        FMocapTakeChunkPool::ReleaseChunk(ChunkPool.Get(), Data, EncodedChunkBytes);
+        ++Stats.NumOverBudgetChunks;
+        return;
+    }
+
+    CommitEncodedChunk<FQuat4f>(Chunk, Data, Stats);
+    Stats.MaxRotationErrorDegrees = FMath::Max(Stats.MaxRotationErrorDegrees, (float)MaxErrorDegrees);
+}
+
+void FMocapTake::DecodeSample(const FMocapTakeChunk& Chunk, int32 Sample, FVector3f& OutTranslation)
+{
+    const uint16* Data = static_cast<const uint16*>(Chunk.Data) + Sample * 3;
+    OutTranslation = Chunk.RangeMin + Chunk.RangeStep * FVector3f((float)Data[0], (float)Data[1], (float)Data[2]);
+}
+
+void FMocapTake::DecodeSample(const FMocapTakeChunk& Chunk, int32 Sample, FQuat4f& OutRotation)
+{
+    OutRotation = DecodeMocapQuat(static_cast<const uint16*>(Chunk.Data) + Sample * 3);
+}
+
+int32 FMocapTake::GetNumConstantChannels() const
+{
+    int32 NumConstant = 0;
+    for (int32 Bone = 0; Bone < NumBones; ++Bone)
+    {
+        NumConstant += Translations[Bone].IsConstant() + Rotations[Bone].IsConstant();
+    }
+    return NumConstant;
+}
+
+SIZE_T FMocapTake::GetAllocatedSize() const
+{
+    SIZE_T Bytes = Translations.GetAllocatedSize() + Rotations.GetAllocatedSize() + Timeline.GetAllocatedSize();
+    for (int32 Bone = 0; Bone < NumBones; ++Bone)
+    {
+        Bytes += Translations[Bone].Chunks.GetAllocatedSize() + Rotations[Bone].Chunks.GetAllocatedSize();
+        for (const FMocapTakeChunk& Chunk : Translations[Bone].Chunks)
+        {
+            Bytes += GetChunkBytes<FVector3f>(Chunk);
+        }
+        for (const FMocapTakeChunk& Chunk : Rotations[Bone].Chunks)
+        {
+            Bytes += GetChunkBytes<FQuat4f>(Chunk);
+        }
+    }
+    return Bytes;
+}
+
+bool FMocapTake::IsWithinTolerance(const FVector3f& A, const FVector3f& B) const
+{
+    return FVector3f::DistSquared(A, B) <= TranslationToleranceSquared;
+}
+
+bool FMocapTake::IsWithinTolerance(const FQuat4f& A, const FQuat4f& B) const
+{
+    // q and -q are the same rotation.
+    const float DistSquaredSame = FMath::Square(A.X - B.X) + FMath::Square(A.Y - B.Y) + FMath::Square(A.Z - B.Z) + FMath::Square(A.W - B.W);
+    const float DistSquaredFlipped = FMath::Square(A.X + B.X) + FMath::Square(A.Y + B.Y) + FMath::Square(A.Z + B.Z) + FMath::Square(A.W + B.W);
+    return FMath::Min(DistSquaredSame, DistSquaredFlipped) <= RotationToleranceSquared;
+}
+
+void FMocapTake::ReleaseChunks()
+{
+    for (TMocapTakeChannel<FVector3f>& Channel : Translations)
+    {
+        ReleaseChannel(Channel);
+    }
+    for (TMocapTakeChannel<FQuat4f>& Channel : Rotations)
+    {
+        ReleaseChannel(Channel);
+    }
+
+    NumFrames = 0;
+    Timeline.Reset();
+}
+
+void FMocapTake::CopyFrom(const FMocapTake& Other)
+{
+    NumBones = Other.NumBones;
+    NumFrames = Other.NumFrames;
+    RootBoneIndex = Other.RootBoneIndex;
+    TranslationOrigin = Other.TranslationOrigin;
+    TranslationToleranceSquared = Other.TranslationToleranceSquared;
+    RotationToleranceSquared = Other.RotationToleranceSquared;
+    SampleRate = Other.SampleRate;
+    Timeline = Other.Timeline;
+    Compression = Other.Compression;
+    CompressionStats = Other.CompressionStats;
+    bDeferEncoding = Other.bDeferEncoding;
+    ChunkPool = Other.ChunkPool;
+
+    // Constants copy as values; full tracks get chunks of their own.
+    Translations.SetNum(NumBones);
+    Rotations.SetNum(NumBones);
+    for (int32 Bone = 0; Bone < NumBones; ++Bone)
+    {
+        CopyChannel(Translations[Bone], Other.Translations[Bone]);
+        CopyChannel(Rotations[Bone], Other.Rotations[Bone]);
+    }
+}
+
+// ------------------------------------------------------------
+// FMocapSampleTimeline
+// ------------------------------------------------------------
+
+void FMocapSampleTimeline::Reset()
+{
+    FirstSampleIndex = 0;
+    NumFrames = 0;
+    SampleIndices.Reset();
+}
+
+int32 FMocapSampleTimeline::AddFrame(int64 SampleIndex)
+{
+    if (NumFrames == 0 && SampleIndex != INDEX_NONE)
+    {
+        // The first frame just anchors a uniform timeline.
+        FirstSampleIndex = FMath::Max<int64>(0, SampleIndex);
+    }
+
+    const int64 NextSampleIndex = GetNextSampleIndex();
+    if (SampleIndex == INDEX_NONE)
+    {
+        SampleIndex = NextSampleIndex;
+    }
+
+    checkf(SampleIndex >= NextSampleIndex, TEXT("Mocap timeline samples must increase (%lld < %lld)"), SampleIndex, NextSampleIndex);
+
+    if (SampleIndices.Num() == 0 && SampleIndex != NextSampleIndex)
+    {
+        // First skipped sample: materialize the uniform part so every stored frame has an explicit index.
+        SampleIndices.Reserve(NumFrames * 2 + 1);
+        for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+        {
+            SampleIndices.Add(FirstSampleIndex + Frame);
+        }
+    }
+
+    if (SampleIndices.Num() > 0)
+    {
+        SampleIndices.Add(SampleIndex);
+    }
+
+    return NumFrames++;
+}
+
+void FMocapSampleTimeline::RemoveLastFrame()
+{
+    if (NumFrames == 0)
+    {
+        return;
+    }
+
+    if (SampleIndices.Num() > 0)
+    {
+        SampleIndices.Pop();
+    }
+    --NumFrames;
+}
+
+void FMocapSampleTimeline::SetFirstSampleIndex(int64 InFirstSampleIndex)
+{
+    check(IsUniform());
+    FirstSampleIndex = FMath::Max<int64>(0, InFirstSampleIndex);
+}
+
+int32 FMocapSampleTimeline::FindFrameAtSample(int64 SampleIndex) const
+{
+    if (NumFrames == 0)
+    {
+        return INDEX_NONE;
+    }
+
+    if (SampleIndices.Num() == 0)
+    {
+        return (int32)FMath::Clamp<int64>(SampleIndex - FirstSampleIndex, 0, NumFrames - 1);
+    }
+
+    // Last frame captured at or before SampleIndex; a skipped sample holds the frame before the gap.
+    const int32 Upper = Algo::UpperBound(SampleIndices, SampleIndex);
+    return FMath::Max(0, Upper - 1);
+}
+
+// ------------------------------------------------------------
+// FMocapRawTake
+// ------------------------------------------------------------
+
+FMocapRawTake::FMocapRawTake(const FMocapRawTake& Other)
+{
+    CopyFrom(Other);
+}
+
+FMocapRawTake::FMocapRawTake(FMocapRawTake&& Other)
+{
+    *this = MoveTemp(Other);
+}
+
+FMocapRawTake& FMocapRawTake::operator=(const FMocapRawTake& Other)
+{
+    if (this != &Other)
+    {
+        ReleaseChunks();
+        CopyFrom(Other);
+    }
+    return *this;
+}
+
+FMocapRawTake& FMocapRawTake::operator=(FMocapRawTake&& Other)
+{
+    if (this != &Other)
+    {
+        ReleaseChunks();
+
+        NumBones = Other.NumBones;
+        NumFrames = Other.NumFrames;
+        NumAllocations = Other.NumAllocations;
+        Timeline = MoveTemp(Other.Timeline);
+        ChunkPool = MoveTemp(Other.ChunkPool);
+        Chunks = MoveTemp(Other.Chunks);
+
+        Other.NumFrames = 0;
+        Other.Timeline.Reset();
+        Other.Chunks.Reset();
+    }
+    return *this;
+}
+
+FMocapRawTake::~FMocapRawTake()
+{
+    ReleaseChunks();
+}
+
+void FMocapRawTake::SetChunkPool(TSharedPtr<FMocapTakeChunkPool> InPool)
+{
+    if (InPool != ChunkPool)
+    {
+        ReleaseChunks();
+        ChunkPool = MoveTemp(InPool);
+    }
+}
+
+void FMocapRawTake::Reset(int32 InNumBones)
+{
+    InNumBones = FMath::Max(0, InNumBones);
+
+    if (InNumBones != NumBones)
+    {
+        ReleaseChunks();
+        NumBones = InNumBones;
+    }
+
+    NumFrames = 0;
+    Timeline.Reset();
+}
+
+void FMocapRawTake::Empty()
+{
+    ReleaseChunks();
+}
+
+void FMocapRawTake::Reserve(int32 InNumFrames)
+{
+    const int32 NumChunksNeeded = FMath::DivideAndRoundUp(FMath::Max(0, InNumFrames), FramesPerChunk);
+    Chunks.Reserve(NumChunksNeeded);
+
+    while (Chunks.Num() < NumChunksNeeded)
+    {
+        Chunks.Add(static_cast<FTransform*>(FMocapTakeChunkPool::AllocateChunk(ChunkPool.Get(), GetChunkBytes())));
+        ++NumAllocations;
+    }
+}
+
+int32 FMocapRawTake::AddFrame(TConstArrayView<FTransform> InComponentSpace, const FTransform& InComponentToWorld, int64 SampleIndex)
+{
+    check(InComponentSpace.Num() == NumBones);
+
+    if (NumFrames == Chunks.Num() * FramesPerChunk)
+    {
+        Chunks.Add(static_cast<FTransform*>(FMocapTakeChunkPool::AllocateChunk(ChunkPool.Get(), GetChunkBytes())));
+        ++NumAllocations;
+    }
+
+    const int32 FrameIndex = NumFrames;
+    FTransform* Chunk = Chunks[FrameIndex / FramesPerChunk];
+    const int32 FrameInChunk = FrameIndex % FramesPerChunk;
+
+    FMemory::Memcpy(Chunk + FrameInChunk * NumBones, InComponentSpace.GetData(), NumBones * sizeof(FTransform));
+    Chunk[FramesPerChunk * NumBones + FrameInChunk] = InComponentToWorld;
+
+    verify(Timeline.AddFrame(SampleIndex) == FrameIndex);
+    ++NumFrames;
+    return FrameIndex;
+}
+
+void FMocapRawTake::ReleaseChunks()
+{
+    const SIZE_T ChunkBytes = GetChunkBytes();
+    for (FTransform* Chunk : Chunks)
+    {
+        FMocapTakeChunkPool::ReleaseChunk(ChunkPool.Get(), Chunk, ChunkBytes);
+    }
+
+    Chunks.Reset();
+    NumFrames = 0;
+    Timeline.Reset();
+}
+
+void FMocapRawTake::CopyFrom(const FMocapRawTake& Other)
+{
+    NumBones = Other.NumBones;
+    NumFrames = 0;
+    ChunkPool = Other.ChunkPool;
+
+    const int32 NumUsedChunks = FMath::DivideAndRoundUp(Other.NumFrames, FramesPerChunk);
+    Reserve(NumUsedChunks * FramesPerChunk);
+    for (int32 ChunkIndex = 0; ChunkIndex < NumUsedChunks; ++ChunkIndex)
+    {
+        FMemory::Memcpy(Chunks[ChunkIndex], Other.Chunks[ChunkIndex], GetChunkBytes());
+    }
+
+    NumFrames = Other.NumFrames;
+    Timeline = Other.Timeline;
+}
+
+// ------------------------------------------------------------
+// FMocapRecordedTake
+// ------------------------------------------------------------
+
+int32 FMocapRecordedTake::GetNumRecordedFrames() const
+{
+    if (IsTransformOnly())
+        return TransformFrames.Num();
+
+    return RawTake.IsEmpty() ? Take.Num() : RawTake.Num();
+}
+
+const TArray<FName>& FMocapRecordedTake::GetBoneNames() const
+{
+    static const TArray<FName> Empty;
+    return Topology.IsValid() ? Topology->BoneNames : Empty;
+}
+
+void FMocapRecordedTake::ResolveRawCapture()
+{
+    if (RawTake.IsEmpty())
+        return;
+
+    const FMocapSkeletonTopology* Topo = Topology.Get();
+    if (!Topo || RawTake.GetNumBones() != Topo->Num())
+    {
+        UE_LOG(LogMocapRecorder, Error, TEXT("MocapRecorder: ResolveRawCapture raw poses do not match the recorded skeleton (%s)."),
+            *SourceName);
+        RawTake.Empty();
+        return;
+    }
+
+    const double StartSeconds = FPlatformTime::Seconds();
+    const int32 NumTasks = MocapRecorderPoseUtils::ResolveRawTake(*Topo, WorldBakeBaselineRoot, SampleRate, RawTake, Take);
+
+    UE_LOG(LogMocapRecorder, Log, TEXT("MocapRecorder: %s resolved %d raw frames x %d bones in %.2f ms (%d tasks), %d/%d channels constant, %d chunks encoded"),
+        *SourceName, RawTake.Num(), Topo->Num(), (FPlatformTime::Seconds() - StartSeconds) * 1000.0, NumTasks,
+        Take.GetNumConstantChannels(), Take.GetNumBones() * 2, Take.GetCompressionStats().NumEncodedChunks);
+
+    // The raw poses are no longer needed: their chunks go back to the pool.
+    RawTake.Empty();
+}
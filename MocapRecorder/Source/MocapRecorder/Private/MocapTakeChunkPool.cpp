@@ -0,0 +1,115 @@
+#include "MocapTakeChunkPool.h"
+
+#include "Misc/ScopeLock.h"
+
+namespace
+{
+    // FQuat/FTransform storage is 16-byte aligned.
+    constexpr uint32 MocapTakeChunkAlignment = 16;
+}
+
+FMocapTakeChunkPool::FMocapTakeChunkPool(uint64 InMaxPooledBytes)
+    : MaxPooledBytes(InMaxPooledBytes)
+{
+}
+
+FMocapTakeChunkPool::~FMocapTakeChunkPool()
+{
+    // Takes hold a shared reference to their pool, so nothing can still be live here.
+    checkf(Stats.LiveBytes == 0, TEXT("Mocap take chunk pool destroyed with %llu live bytes"), Stats.LiveBytes);
+    Trim();
+}
+
+void* FMocapTakeChunkPool::Allocate(SIZE_T NumBytes)
+{
+    {
+        FScopeLock Lock(&Mutex);
+
+        Stats.LiveBytes += NumBytes;
+        Stats.PeakLiveBytes = FMath::Max(Stats.PeakLiveBytes, Stats.LiveBytes);
+
+        if (TArray<void*>* Free = FreeChunks.Find(NumBytes))
+        {
+            if (Free->Num() > 0)
+            {
+                Stats.PooledBytes -= NumBytes;
+                ++Stats.NumReuses;
+                return Free->Pop();
+            }
+        }
+
+        ++Stats.NumHeapAllocations;
+    }
+
+    return FMemory::Malloc(NumBytes, MocapTakeChunkAlignment);
+}
+
+void FMocapTakeChunkPool::Release(void* Chunk, SIZE_T NumBytes)
+{
+    if (!Chunk)
+        return;
+
+    {
+        FScopeLock Lock(&Mutex);
+
+        check(Stats.LiveBytes >= NumBytes);
+        Stats.LiveBytes -= NumBytes;
+
+        if (Stats.PooledBytes + NumBytes <= MaxPooledBytes)
+        {
+            FreeChunks.FindOrAdd(NumBytes).Add(Chunk);
+            Stats.PooledBytes += NumBytes;
+            return;
+        }
+    }
+
+    FMemory::Free(Chunk);
+}
+
+void FMocapTakeChunkPool::Trim()
+{
+    TMap<SIZE_T, TArray<void*>> ToFree;
+    {
+        FScopeLock Lock(&Mutex);
+        ToFree = MoveTemp(FreeChunks);
+        FreeChunks.Reset();
+        Stats.PooledBytes = 0;
+    }
+
+    for (TPair<SIZE_T, TArray<void*>>& Pair : ToFree)
+    {
+        for (void* Chunk : Pair.Value)
+        {
+            FMemory::Free(Chunk);
+        }
+    }
+}
+
+void FMocapTakeChunkPool::ResetPeak()
+{
+    FScopeLock Lock(&Mutex);
+    Stats.PeakLiveBytes = Stats.LiveBytes;
+}
+
+FMocapTakeChunkPoolStats FMocapTakeChunkPool::GetStats() const
+{
+    FScopeLock Lock(&Mutex);
+    return Stats;
+}
+
+void* FMocapTakeChunkPool::AllocateChunk(FMocapTakeChunkPool* Pool, SIZE_T NumBytes)
+{
+    return Pool ? Pool->Allocate(NumBytes) : FMemory::Malloc(NumBytes, MocapTakeChunkAlignment);
+}
+
+void FMocapTakeChunkPool::ReleaseChunk(FMocapTakeChunkPool* Pool, void* Chunk, SIZE_T NumBytes)
+{
+    if (Pool)
+    {
+        Pool->Release(Chunk, NumBytes);
+    }
+    else
+    {
+        FMemory::Free(Chunk);
+    }
+}
@@ -0,0 +1,246 @@
+#include "Misc/AutomationTest.h"
+#include "MocapRecorderPoseUtils.h"
+#include "MocapRecorderTypes.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+    // Largest allowed deviation from FTransform::GetRelativeTransform.
+    constexpr double MocapLocalKernelTranslationTolerance = 1e-3; // cm
+    constexpr double MocapLocalKernelRotationTolerance = 1e-4;    // rad
+
+    // Previous capture path: every bone rebased to the session (InvBaseline * World), locals taken between
+    // rebased poses, the root kept as its rebased pose.
+    void ComputeRebasedWorldLocals(
+        TConstArrayView<FTransform> ComponentBySkel,
+        TConstArrayView<int32> ParentBySkel,
+        const FTransform& InvBaseline,
+        const FTransform& ComponentToWorld,
+        TArray<FTransform>& OutLocals)
+    {
+        const int32 Num = ComponentBySkel.Num();
+        TArray<FTransform> WorldRel;
+        WorldRel.SetNum(Num);
+        for (int32 i = 0; i < Num; ++i)
+        {
+            WorldRel[i] = InvBaseline * (ComponentBySkel[i] * ComponentToWorld);
+        }
+
+        OutLocals.SetNum(Num);
+        for (int32 i = 0; i < Num; ++i)
+        {
+            const int32 Parent = ParentBySkel[i];
+            OutLocals[i] = (Parent == INDEX_NONE) ? WorldRel[i] : WorldRel[i].GetRelativeTransform(WorldRel[Parent]);
+        }
+    }
+
+    // Rigid component-space chain built from parent-relative locals (parents precede children).
+    void BuildRigidComponentPose(TConstArrayView<int32> ParentBySkel, TConstArrayView<FTransform> LocalBySkel, TArray<FTransform>& OutComponent)
+    {
+        OutComponent.SetNum(LocalBySkel.Num());
+        for (int32 i = 0; i < LocalBySkel.Num(); ++i)
+        {
+            const int32 Parent = ParentBySkel[i];
+            OutComponent[i] = (Parent == INDEX_NONE) ? LocalBySkel[i] : LocalBySkel[i] * OutComponent[Parent];
+        }
+    }
+
+    FMocapSkeletonTopology MakeTestTopology(TConstArrayView<int32> ParentBySkel)
+    {
+        FMocapSkeletonTopology Topology;
+        Topology.RootIndex = 0;
+        Topology.NumSkeletonBones = ParentBySkel.Num();
+        Topology.ParentIndices = TArray<int32>(ParentBySkel.GetData(), ParentBySkel.Num());
+        Topology.FirstChildIndices.Init(INDEX_NONE, ParentBySkel.Num());
+        for (int32 i = ParentBySkel.Num() - 1; i > 0; --i)
+        {
+            Topology.FirstChildIndices[ParentBySkel[i]] = i;
+        }
+        for (int32 i = 0; i < ParentBySkel.Num(); ++i)
+        {
+            Topology.BoneNames.Add(*FString::Printf(TEXT("Bone%d"), i));
+            Topology.SkeletonIndices.Add(i);
+        }
+        return Topology;
+    }
+
+    double GetTranslationError(const FVector& A, const FVector& B)
+    {
+        return FVector::Dist(A, B);
+    }
+
+    double GetRotationError(const FQuat& A, const FQuat& B)
+    {
+        return A.GetNormalized().AngularDistance(B.GetNormalized());
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+    FMocapParentRelativeLocalsTest,
+    "MocapRecorder.PoseUtils.ComputeParentRelativeLocals",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FMocapParentRelativeLocalsTest::RunTest(const FString& Parameters)
+{
+    // Synthetic component-space poses; only each bone/parent pair matters, not hierarchy consistency.
+    const FQuat RotA = FQuat(FRotator(30.0, -45.0, 10.0));
+    const FQuat RotB = FQuat(FRotator(-80.0, 120.0, 35.0));
+    const FQuat RotC = FQuat(FRotator(5.0, 170.0, -60.0));
+
+    const TArray<FTransform> ComponentBySkel =
+    {
+        FTransform(RotA, FVector(12.0, -3.0, 95.0), FVector(1.0)),                    // 0: root
+        FTransform(RotB, FVector(20.0, 4.0, 110.0), FVector(1.5, 1.5, 1.5)),          // 1: uniform scale
+        FTransform(RotC, FVector(-7.0, 31.0, 140.0), FVector(0.5, 2.0, 1.25)),        // 2: non-uniform scale
+        FTransform(RotA * RotB, FVector(3.0, 60.0, 150.0), FVector(-1.0, 1.0, 1.0)),  // 3: mirrored (one negative axis)
+        FTransform(RotB * RotC, FVector(-40.0, 2.0, 80.0), FVector(-0.75, 1.5, -2.0)), // 4: two negative axes, non-uniform
+        FTransform(RotC, FVector(15.0, -22.0, 45.0), FVector(1.0)),                   // 5: child of non-uniform
+        FTransform(RotA, FVector(-9.0, 71.0, 162.0), FVector(1.0)),                   // 6: child of mirrored
+        FTransform(RotB, FVector(-55.0, -8.0, 60.0), FVector(2.0, 0.5, 1.0)),         // 7: child of two negative axes
+    };
+    const TArray<int32> ParentBySkel = { INDEX_NONE, 0, 1, 1, 0, 2, 3, 4 };
+
+    const int32 Num = ComponentBySkel.Num();
+    const FVector RootSentinelTranslation(1234.0, 5678.0, 9012.0);
+
+    TArray<FVector> LocalTranslations;
+    TArray<FQuat> LocalRotations;
+    LocalTranslations.Init(RootSentinelTranslation, Num);
+    LocalRotations.Init(FQuat::Identity, Num);
+
+    MocapRecorderPoseUtils::ComputeParentRelativeLocals(ComponentBySkel, ParentBySkel, LocalTranslations, LocalRotations);
+
+    TestEqual(TEXT("Parentless bones are left untouched"), LocalTranslations[0], RootSentinelTranslation);
+
+    for (int32 i = 0; i < Num; ++i)
+    {
+        const int32 Parent = ParentBySkel[i];
+        if (Parent == INDEX_NONE)
+            continue;
+
+        const FTransform Reference = ComponentBySkel[i].GetRelativeTransform(ComponentBySkel[Parent]);
+
+        const double TranslationError = FVector::Dist(Reference.GetTranslation(), LocalTranslations[i]);
+        const double RotationError = Reference.GetRotation().GetNormalized().AngularDistance(LocalRotations[i]);
+
+        TestTrue(FString::Printf(TEXT("Bone %d translation within %g cm (error %g, parent scale %s)"),
+            i, MocapLocalKernelTranslationTolerance, TranslationError, *ComponentBySkel[Parent].GetScale3D().ToString()),
+            TranslationError <= MocapLocalKernelTranslationTolerance);
+        TestTrue(FString::Printf(TEXT("Bone %d rotation within %g rad (error %g, parent scale %s)"),
+            i, MocapLocalKernelRotationTolerance, RotationError, *ComponentBySkel[Parent].GetScale3D().ToString()),
+            RotationError <= MocapLocalKernelRotationTolerance);
+        TestTrue(FString::Printf(TEXT("Bone %d rotation is normalized"), i), LocalRotations[i].IsNormalized());
+    }
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+    FMocapSessionLocalsBaselineTest,
+    "MocapRecorder.PoseUtils.WriteSessionLocalsToTake.Baseline",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FMocapSessionLocalsBaselineTest::RunTest(const FString& Parameters)
+{
+    // Rigid skeleton (unit scale) so the conjugation relationship below is exact.
+    const TArray<int32> ParentBySkel = { INDEX_NONE, 0, 1, 2, 1, 4, 0 };
+    const TArray<FTransform> LocalBySkel =
+    {
+        FTransform(FQuat(FRotator(0.0, 90.0, 0.0)), FVector(0.0, 0.0, 95.0)),
+        FTransform(FQuat(FRotator(10.0, 0.0, 5.0)), FVector(0.0, 0.0, 20.0)),
+        FTransform(FQuat(FRotator(-35.0, 20.0, 0.0)), FVector(15.0, 0.0, 30.0)),
+        FTransform(FQuat(FRotator(60.0, -10.0, 15.0)), FVector(25.0, 0.0, 0.0)),
+        FTransform(FQuat(FRotator(0.0, -45.0, 80.0)), FVector(-15.0, 0.0, 30.0)),
+        FTransform(FQuat(FRotator(20.0, 30.0, -40.0)), FVector(0.0, 28.0, 0.0)),
+        FTransform(FQuat(FRotator(-5.0, 0.0, 0.0)), FVector(10.0, -12.0, -40.0)),
+    };
+    const int32 Num = ParentBySkel.Num();
+
+    TArray<FTransform> ComponentBySkel;
+    BuildRigidComponentPose(ParentBySkel, LocalBySkel, ComponentBySkel);
+
+    const FMocapSkeletonTopology Topology = MakeTestTopology(ParentBySkel);
+    const FTransform ComponentToWorld(FQuat(FRotator(0.0, -30.0, 0.0)), FVector(25000.0, -4000.0, 120.0));
+
+    // Session origin (bPreserveStartingLocation) and actor-start root (rebase-to-actor-start) style baselines.
+    const TArray<FTransform> Baselines =
+    {
+        FTransform::Identity,
+        FTransform(FQuat::Identity, FVector(24000.0, -3500.0, 0.0)),
+        ComponentBySkel[0] * ComponentToWorld,
+    };
+
+    TArray<FVector> FirstBaselineTranslations;
+    TArray<FQuat> FirstBaselineRotations;
+
+    for (int32 BaselineIdx = 0; BaselineIdx < Baselines.Num(); ++BaselineIdx)
+    {
+        const FTransform& Baseline = Baselines[BaselineIdx];
+        const FTransform InvBaseline = Baseline.Inverse();
+
+        FMocapTake Take;
+        Take.Reset(Num, Topology.RootIndex);
+        const int32 FrameIndex = Take.AddFrameUninitialized(0);
+
+        FMocapLocalPoseScratch Scratch;
+        MocapRecorderPoseUtils::WriteSessionLocalsToTake(Topology, InvBaseline, ComponentBySkel, ComponentToWorld, Take, FrameIndex, Scratch);
+
+        TArray<FTransform> OldLocals;
+        ComputeRebasedWorldLocals(ComponentBySkel, ParentBySkel, InvBaseline, ComponentToWorld, OldLocals);
+
+        for (int32 i = 0; i < Num; ++i)
+        {
+            const FVector& NewT = Scratch.LocalTranslations[i];
+            const FQuat& NewR = Scratch.LocalRotations[i];
+
+            // Root: unchanged from the previous path (the only baseline-dependent bone).
+            // Parented bones: the previous result with the baseline conjugation removed (Baseline * Old * InvBaseline),
+            // which is the component-space local; with an identity baseline the two paths agree outright.
+            const FTransform Expected = (ParentBySkel[i] == INDEX_NONE) ? OldLocals[i] : Baseline * OldLocals[i] * InvBaseline;
+
+            TestTrue(FString::Printf(TEXT("Baseline %d bone %d translation matches the previous path (error %g)"),
+                BaselineIdx, i, GetTranslationError(Expected.GetTranslation(), NewT)),
+                GetTranslationError(Expected.GetTranslation(), NewT) <= MocapLocalKernelTranslationTolerance);
+            TestTrue(FString::Printf(TEXT("Baseline %d bone %d rotation matches the previous path (error %g)"),
+                BaselineIdx, i, GetRotationError(Expected.GetRotation(), NewR)),
+                GetRotationError(Expected.GetRotation(), NewR) <= MocapLocalKernelRotationTolerance);
+
+            if (ParentBySkel[i] == INDEX_NONE)
+                continue;
+
+            // Parented locals are the skeleton's own locals, whatever the baseline.
+            TestTrue(FString::Printf(TEXT("Baseline %d bone %d recovers its local translation"), BaselineIdx, i),
+                GetTranslationError(LocalBySkel[i].GetTranslation(), NewT) <= MocapLocalKernelTranslationTolerance);
+            TestTrue(FString::Printf(TEXT("Baseline %d bone %d recovers its local rotation"), BaselineIdx, i),
+                GetRotationError(LocalBySkel[i].GetRotation(), NewR) <= MocapLocalKernelRotationTolerance);
+
+            if (BaselineIdx == 0)
+                continue;
+
+            TestTrue(FString::Printf(TEXT("Baseline %d bone %d translation is baseline-independent"), BaselineIdx, i),
+                GetTranslationError(FirstBaselineTranslations[i], NewT) <= MocapLocalKernelTranslationTolerance);
+            TestTrue(FString::Printf(TEXT("Baseline %d bone %d rotation is baseline-independent"), BaselineIdx, i),
+                GetRotationError(FirstBaselineRotations[i], NewR) <= MocapLocalKernelRotationTolerance);
+        }
+
+        if (BaselineIdx == 0)
+        {
+            FirstBaselineTranslations = Scratch.LocalTranslations;
+            FirstBaselineRotations = Scratch.LocalRotations;
+        }
+    }
+
+    // The translated session origin is where the previous path went wrong: its child translations picked up the offset.
+    {
+        const FTransform InvBaseline = Baselines[1].Inverse();
+        TArray<FTransform> OldLocals;
+        ComputeRebasedWorldLocals(ComponentBySkel, ParentBySkel, InvBaseline, ComponentToWorld, OldLocals);
+        TestTrue(TEXT("Previous path differs from the component-space locals for a non-identity baseline"),
+            GetTranslationError(OldLocals[3].GetTranslation(), LocalBySkel[3].GetTranslation()) > 1.0);
+    }
+
+    return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
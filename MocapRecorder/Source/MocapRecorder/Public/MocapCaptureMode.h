@@ -13,3 +13,48 @@ enum class EMocapCaptureMode : uint8
     TransformOnly UMETA(Hidden, DisplayName = "Transform Only (Deprecated)")
 };
 
+
+// How the recorder obtains the component-space pose it samples.
+UENUM(BlueprintType)
+enum class EMocapPoseEvaluation : uint8
+{
+    // Re-run TickAnimation(0)/RefreshBoneTransforms before every sample (legacy behavior).
+    ForceEvaluate UMETA(DisplayName = "Force Evaluate"),
+
+    // Read the pose the mesh already finalized this frame; force evaluation only when it is stale.
+    ReuseFinalizedPose UMETA(DisplayName = "Reuse Finalized Pose")
+};
+
+
+// What the recorder stores per captured frame.
+UENUM(BlueprintType)
+enum class EMocapPoseStorage : uint8
+{
+    // Derive session-relative parent-local transforms while capturing (ready to bake).
+    Derived UMETA(DisplayName = "Derived Locals"),
+
+    // Store the raw component-space pose + component-to-world only; locals are derived in parallel at bake time.
+    RawComponentSpace UMETA(DisplayName = "Raw Component Space")
+};
+
+
+// Which bones of the skeleton a recorder captures. Ancestors of every captured bone (and the root) are always
+// captured too, so the recorded bones form a complete hierarchy; bones outside it bake as the reference pose.
+UENUM(BlueprintType)
+enum class EMocapBoneMaskMode : uint8
+{
+    // Every bone.
+    All UMETA(DisplayName = "All Bones"),
+
+    // Only the listed bones.
+    Include UMETA(DisplayName = "Include"),
+
+    // Every bone except the listed ones and everything below them.
+    Exclude UMETA(DisplayName = "Exclude"),
+
+    // The listed bones and everything below them.
+    BranchRoots UMETA(DisplayName = "Branch Roots"),
+
+    // The root bone only (props, projectiles).
+    RootOnly UMETA(DisplayName = "Root Only")
+};
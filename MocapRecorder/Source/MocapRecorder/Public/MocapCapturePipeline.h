@@ -0,0 +1,108 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/CircularQueue.h"
+#include "HAL/Runnable.h"
+
+#include <atomic>
+
+class FEvent;
+class FRunnableThread;
+class UMocapRecorderComponent;
+
+/**
+ * One raw pose handed from the game thread to the capture worker.
+ * Packets are pooled by the pipeline; their transform buffers keep their capacity between uses.
+ */
+struct FMocapCapturePacket
+{
+    UMocapRecorderComponent* Recorder = nullptr;
+    int64 SampleIndex = INDEX_NONE;
+    TArray<FTransform> ComponentSpaceTransforms;
+    FTransform ComponentToWorld = FTransform::Identity;
+};
+
+/** Backpressure counters for one pipeline. Snapshot values; read on the game thread. */
+struct FMocapCapturePipelineStats
+{
+    int32 Capacity = 0;
+
+    /** Deepest the ready queue got (packets submitted but not yet committed). */
+    int32 QueueDepthHighWater = 0;
+
+    int64 NumSubmitted = 0;
+    int64 NumCommitted = 0;
+
+    /** Packets the worker could not commit (recorder skeleton info no longer matched). */
+    int64 NumDropped = 0;
+
+    /** Submissions that had to wait for a free packet, and the total time spent waiting. */
+    int64 NumStalls = 0;
+    double StallSeconds = 0.0;
+};
+
+/**
+ * Per-session capture stage: the game thread copies each evaluated pose into a pooled packet and pushes it
+ * onto a bounded single-producer/single-consumer queue; one worker thread drains it, derives the
+ * baseline-relative locals and appends them to the recorder's take.
+ *
+ * A single worker keeps every recorder's frames in submission order. While a recorder is attached,
+ * its take belongs to the worker: the game thread must Flush() before reading it.
+ * When the queue is full the game thread stalls until a packet is free (no frame is ever skipped).
+ */
+class MOCAPRECORDER_API FMocapCapturePipeline : public FRunnable
+{
+public:
+    explicit FMocapCapturePipeline(int32 InCapacity = 1024);
+    virtual ~FMocapCapturePipeline() override;
+
+    FMocapCapturePipeline(const FMocapCapturePipeline&) = delete;
+    FMocapCapturePipeline& operator=(const FMocapCapturePipeline&) = delete;
+
+    // ------------------------------------------------------------
+    // Game thread
+    // ------------------------------------------------------------
+
+    /** Returns a free packet index, stalling while every packet is in flight. */
+    int32 AcquirePacket();
+
+    FMocapCapturePacket& GetPacket(int32 PacketIndex) { return Packets[PacketIndex]; }
+
+    /** Queues an acquired, filled packet for the worker. */
+    void Submit(int32 PacketIndex);
+
+    /** Blocks until every packet submitted before this call has been committed. */
+    void Flush();
+
+    FMocapCapturePipelineStats GetStats() const;
+
+    // ------------------------------------------------------------
+    // FRunnable
+    // ------------------------------------------------------------
+    virtual uint32 Run() override;
+    virtual void Stop() override;
+
+private:
+    /** Commits every queued packet. Returns false if the queue was empty. */
+    bool DrainReadyQueue();
+
+    TArray<FMocapCapturePacket> Packets;
+
+    // Game thread -> worker: filled packets. Worker -> game thread: packets free for reuse.
+    TCircularQueue<int32> ReadyQueue;
+    TCircularQueue<int32> FreeQueue;
+
+    FEvent* WorkEvent = nullptr;
+    FEvent* CommittedEvent = nullptr;
+    FRunnableThread* Thread = nullptr;
+
+    std::atomic<bool> bStopping{ false };
+    std::atomic<int64> NumCommitted{ 0 };
+    std::atomic<int64> NumDropped{ 0 };
+
+    // Game thread only
+    int64 NumSubmitted = 0;
+    int64 NumStalls = 0;
+    double StallSeconds = 0.0;
+    int32 QueueDepthHighWater = 0;
+};
@@ -14,6 +14,9 @@
 class USkeletalMeshComponent;
 class USkeleton;
 class USkeletalMesh;
+class FMocapCapturePipeline;
+class FMocapTakeChunkPool;
+struct FMocapCapturePacket;
 
 
 /**
@@ -41,6 +44,8 @@ public:
     *
     * - If SessionOrigin is identity, root becomes absolute world motion.
     * - If SessionOrigin is set by the editor session, root becomes world motion relative to that origin.
+    *
+    * Either way only the root track is rebased; every other bone records its parent-relative local pose.
     */
 
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mocap|Recording")
@@ -58,7 +63,7 @@ public:
 
     // Session sample index at which this recorder started (used to align + spawn behavior).
     UPROPERTY(Transient, BlueprintReadOnly, Category = "Mocap|Recording")
-    int32 StartSampleIndex = 0;
+    int64 StartSampleIndex = 0;
 
     
     UMocapRecorderComponent();
@@ -97,12 +102,42 @@ public:
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mocap|Recording", meta = (ClampMin = "1"))
     float SampleRate = 60.f;
 
+    /**
+     * Pose source for sampling. ReuseFinalizedPose reads the pose the mesh already evaluated this frame
+     * and only forces a re-evaluation when that pose is stale (mesh has not ticked this frame, parallel
+     * evaluation still in flight, or this frame's pose was already captured).
+     */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mocap|Recording")
+    EMocapPoseEvaluation PoseEvaluation = EMocapPoseEvaluation::ReuseFinalizedPose;
+
+    /**
+     * RawComponentSpace makes capture a bulk copy of the component-space pose (+ component-to-world); parent-relative
+     * locals are derived in parallel by FMocapRecordedTake::ResolveRawCapture when baking. Derived converts while capturing.
+     */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mocap|Recording")
+    EMocapPoseStorage PoseStorage = EMocapPoseStorage::Derived;
+
+    /** Lossy take encoding for very long or very large sessions; achieved error is reported in the capture stats. */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mocap|Recording")
+    FMocapTakeCompression TakeCompression;
+
+    /**
+     * Bones to capture. Capture cost and take memory scale with the recorded bones; the bake fills the
+     * others from the mesh reference pose. Applied when recording starts.
+     */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mocap|Recording")
+    FMocapBoneMask BoneMask;
+
     /** Automatically export on StopRecording() (single-capture only) */
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mocap|Recording")
     bool bAutoExportOnStop = false;
 
-    /** Create a transient snapshot containing recorded data for post-PIE baking. */
-    UMocapRecorderComponent* CreateBakeSnapshot() const;
+    /**
+     * Hands the recorded data over for post-PIE baking as a plain FMocapRecordedTake. Takes and transform frames
+     * are moved, not copied, so stopping many recorders at once costs no extra memory; this recorder is left empty.
+     * Stops recording first if it is still running.
+     */
+    FMocapRecordedTake TransferRecordedTake();
     
     // ============================================================================
     // Session-driven sampling (multi-capture)
@@ -117,18 +152,32 @@ public:
     void StartRecording_External();
 
     /** Start recording for transform-only actors (bullets/casings). */
-    void StartRecording_ExternalTransformOnly(int32 InStartSampleIndex);
+    void StartRecording_ExternalTransformOnly(int64 InStartSampleIndex);
 
     /**
      * Start recording with a static preroll pad (N frames) so spawned instances align to session timeline.
      * Example: if the bullet spawns 120 samples into the session, pass PreRollFrames=120 so it stays
-     * static until its real motion begins.
+     * static until its real motion begins. The pad is sparse: one hold pose stored at sample PreRollFrames-1,
+     * which the take timeline holds for every earlier sample.
      */
-    void StartRecording_ExternalWithPreRoll(int32 PreRollFrames);
+    void StartRecording_ExternalWithPreRoll(int64 PreRollFrames);
 
-    /** Stop recording without touching internal timers (session manager owns timer). */
+    /** Stop recording without touching internal timers (session manager owns timer). Flushes the capture pipeline. */
     void StopRecording_External();
 
+    /**
+     * Route skeletal samples through a session capture pipeline (null = convert inline).
+     * While attached, SampleFrame only copies the pose; the take is written by the pipeline worker and must not
+     * be read until StopRecording_External has flushed it. Not for BoneTransformsFinalized sampling.
+     */
+    void SetCapturePipeline(TSharedPtr<FMocapCapturePipeline> InPipeline);
+
+    /** Pipeline worker only: appends the packet's pose to the take. False if it no longer matches the skeleton. */
+    bool CommitPipelinedPose(const FMocapCapturePacket& Packet);
+
+    /** Draw take chunks (raw and derived) from a session pool (null = heap). Ignored while recording. */
+    void SetTakeChunkPool(TSharedPtr<FMocapTakeChunkPool> InPool);
+
 
     // =====================================================
     // Control (single-capture)
@@ -150,19 +199,66 @@ public:
     // Sampling
     // =====================================================
 
-    /** Capture one frame of data (called by timer or session manager) */
+    /** Capture one frame of data at the sample after the last one (called by timer or session manager) */
     void SampleFrame();
 
+    /**
+     * Capture the current pose at session sample SessionSampleIndex. Does nothing if that sample (or a later one)
+     * is already captured, so repeated poses within one sample period are dropped. Samples skipped by a hitch
+     * are not stored: the take timeline records the gap and they hold the previous frame.
+     * bPoseFinalized: called from the mesh's OnBoneTransformsFinalized, so its pose is read as is and never
+     * re-evaluated (a forced evaluation there would broadcast the callback again). Re-entrant calls are ignored.
+     */
+    void SampleFrameAtSessionIndex(int64 SessionSampleIndex, bool bPoseFinalized = false);
+
+    /**
+     * Deferred sampling, game-thread half: evaluate/validate the pose, reserve the next take frame and copy the
+     * component-space transforms. Returns true if a pose is pending and SampleFrame_CommitSnapshot must follow
+     * before the next sample. Transform-only and pipelined recorders sample completely here and return false.
+     * SessionSampleIndex as for SampleFrameAtSessionIndex; INDEX_NONE takes the sample after the last one.
+     */
+    bool SampleFrame_Snapshot(int64 SessionSampleIndex = INDEX_NONE);
+
+    /**
+     * Deferred sampling, worker half: converts the pending snapshot into its reserved take frame.
+     * Touches only this recorder's take and scratch, so different recorders may commit in parallel. May acquire
+     * take chunks (channel promotion, chunk encoding) from the session pool.
+     * Produces exactly the frame SampleFrame would have.
+     */
+    void SampleFrame_CommitSnapshot();
+
     // =====================================================
     // Accessors (used by bake/export)
     // =====================================================
 
-    const TArray<FMocapFrame>& GetRecordedFrames() const;
+    /** Recorded take (structure-of-arrays, bone-major). Empty for raw captures: bakes resolve the handed-over FMocapRecordedTake. */
+    const FMocapTake& GetRecordedFrames() const;
+
+    /**
+     * Bone head/tail positions for stored frames [FirstFrame, FirstFrame + NumFrames), rebuilt from the take's locals
+     * (they are not stored). Output is frame-major in recording bone order: Out[Frame * NumBones + Bone].
+     * Positions are session-relative, or absolute world when bAbsoluteWorld (re-applies WorldBakeBaselineRoot).
+     * A bone's tail is its first child's head, or its own head for leaves. Derived takes only.
+     */
+    bool ComputeHeadTailPositions(int32 FirstFrame, int32 NumFrames, TArray<FVector>& OutHeads, TArray<FVector>& OutTails, bool bAbsoluteWorld = false) const;
+
+    /** Stored frames captured so far, raw or derived. Held samples (preroll, hitches) are not counted. */
+    int32 GetNumRecordedFrames() const;
 
     const TArray<FMocapTransformFrame>& GetRecordedTransformFrames() const { return TransformFrames; }
-    const TArray<FName>& GetRecordedBoneNames() const { return RecordedBoneNames; }
+
+    /** Per-recording sampling counters (allocations per sample, etc.). Reset on every StartRecording*. */
+    const FMocapCaptureStats& GetCaptureStats() const { return CaptureStats; }
+    const TArray<FName>& GetRecordedBoneNames() const;
+
+    /** Shared per-mesh (and bone mask) layout of the recorded bones. Null until skeleton info is built. */
+    const TSharedPtr<const FMocapSkeletonTopology>& GetSkeletonTopology() const { return Topology; }
     float GetRecordedSampleRate() const { return SampleRate; }
+
+    /** SampleRate as the exact rational rate of the take timeline (integer Hz, NTSC or millihertz). */
+    FFrameRate GetRecordedFrameRate() const;
     USkeleton* GetRecordedSkeleton() const { return RecordedSkeleton; }
+    USkeletalMesh* GetRecordedMeshAsset() const { return RecordedMeshAsset; }
 
     /**
     * Editor/bake helper: override the skeleton used for baking.
@@ -200,8 +296,41 @@ private:
     void StartDiagnosticLog();
     void StopDiagnosticLog();
 
-    /** Captures current pose into OutFrame without appending to Frames or advancing TimeFromStart. */
-    bool CaptureCurrentPoseToFrame(FMocapFrame& OutFrame);
+    /**
+     * Captures the current pose straight into a new take frame (no temporaries) at session sample SampleIndex.
+     * Returns the new frame index, or INDEX_NONE on failure (no frame is added).
+     */
+    int32 CaptureCurrentPoseToTake(int64 SampleIndex, bool bPoseFinalized = false);
+
+    /** Captures one sample through whichever path this recorder uses (transform, pipeline, inline). */
+    bool CaptureSample(int64 SampleIndex, bool bPoseFinalized = false);
+
+    /**
+     * Validates the target and makes its pose current. Returns the component-space pose, or null on failure.
+     * bPoseFinalized: the caller knows the pose is final (finalize callback); it is never re-evaluated.
+     */
+    const TArray<FTransform>* EvaluatePoseForCapture(bool bPoseFinalized = false);
+
+    /** Appends an uninitialized take frame at SampleIndex, counting any growth as a sample allocation. */
+    int32 ReserveTakeFrame(int64 SampleIndex);
+
+    /**
+     * Converts a component-space pose to session-relative locals and writes them into FrameIndex. No UObject access;
+     * safe to run for different frames concurrently with separate scratch. Returns the scratch and take chunk allocations made.
+     */
+    int32 WritePoseToTakeFrame(TConstArrayView<FTransform> CSTransforms, const FTransform& ComponentToWorld, int32 FrameIndex, FMocapLocalPoseScratch& Scratch);
+
+    /** Game-thread half of a pipelined sample: evaluate and copy the pose into a pipeline packet. */
+    bool SubmitPoseToPipeline(int64 SampleIndex, bool bPoseFinalized = false);
+
+    /** True if TargetSkeletalMesh's component-space pose for this frame is final and not yet captured. */
+    bool IsFinalizedPoseCurrent() const;
+
+    /** Game thread, after a pipeline flush: folds the worker's counters into CaptureStats. */
+    void MergePipelineCaptureStats();
+
+    /** Logs CaptureStats for this recording. */
+    void LogCaptureStats() const;
 
 
     // =====================================================
@@ -211,29 +340,44 @@ private:
     /** Accumulated time used for fixed-step sampling */
     float TimeAccumulator = 0.f;
 
-    /** Time since recording started */
-    float TimeFromStart = 0.f;
+    /** Session sample of the last captured frame. Game thread only: a pipelined take belongs to the worker. */
+    int64 LastSampleIndex = INDEX_NONE;
+
+    /** Set while SampleFrameAtSessionIndex captures; a pose refresh broadcasting the finalize callback must not nest. */
+    bool bCapturing = false;
 
     /** Total frames recorded */
     int32 RecordedFrameCount = 0;
 
-    /** Recorded per-frame transform-only data (only used when bTransformOnly=true) */
-    TArray<FMocapTransformFrame> TransformFrames;
+    /** Sampling counters for the current recording */
+    FMocapCaptureStats CaptureStats;
 
-    /** Bone names in recording order */
-    TArray<FName> RecordedBoneNames;
+    /** GFrameCounter of the last pose capture (detects repeated samples within one game frame). */
+    uint64 LastPoseCaptureFrame = MAX_uint64;
 
-    /** Parent export-bone index for each export bone. INDEX_NONE for root. */
-    UPROPERTY()
-    TArray<int32> BoneParentIndices;
+    /** Persistent per-sample scratch: parent-relative translations and rotations per recorded bone (root is session-relative). */
+    FMocapLocalPoseScratch CaptureScratch;
 
-    /** RefSkeleton bone indices corresponding to each export bone. */
-    UPROPERTY()
-    TArray<int32> BoneSkeletonIndices;
+    /** Masked topologies: the evaluated pose gathered down to the recorded bones (topology order). */
+    TArray<FTransform> MaskedPose;
 
-    /** Export bone names in export order (matches Translations/Rotations arrays). */
-    UPROPERTY()
-    TArray<FName> BoneNames;
+    /** Pose copied by SampleFrame_Snapshot, pending SampleFrame_CommitSnapshot. */
+    FMocapPoseSnapshot PendingSnapshot;
+
+    /** Session capture pipeline that owns take writes while attached. */
+    TSharedPtr<FMocapCapturePipeline> CapturePipeline;
+
+    /** Sample allocations made by the pipeline worker. Worker only while attached; merged into CaptureStats after a flush. */
+    int64 PipelineSampleAllocations = 0;
+
+    /** Recorded per-frame transform-only data (only used when bTransformOnly=true) */
+    TArray<FMocapTransformFrame> TransformFrames;
+
+    /**
+     * Bone names, parent indices and skeleton indices in recording order.
+     * Owned by the topology cache and shared by every recorder of the same mesh and bone mask.
+     */
+    TSharedPtr<const FMocapSkeletonTopology> Topology;
 
 
     /** Skeleton used during recording */
@@ -245,8 +389,11 @@ private:
     TObjectPtr<USkeletalMesh> RecordedMeshAsset = nullptr;
 
 
-    /** Recorded per-frame data */
-    TArray<FMocapFrame> Frames;
+    /** Recorded take data: per bone, a translation and a rotation channel, each a single constant or fixed-size chunks from the session pool. */
+    FMocapTake Take;
+
+    /** Raw component-space poses (PoseStorage == RawComponentSpace); moved into the bake job, which derives the locals. */
+    FMocapRawTake RawTake;
 
 
 
@@ -1,47 +1,637 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Misc/FrameRate.h"
+#include "Templates/SharedPointer.h"
+#include "UObject/SoftObjectPtr.h"
+#include "MocapCaptureMode.h"
 #include "MocapRecorderTypes.generated.h"
 
-/**
- * One captured frame of mocap data.
- * Stored in skeleton bone order.
- */
+class FMocapTakeChunkPool;
+class USkeleton;
+class USkeletalMesh;
+
+// ------------------------------------------------------------
+// Transform-only capture (bullets/casings/props)
+// ------------------------------------------------------------
 USTRUCT()
-struct FMocapFrame
+struct FMocapTransformFrame
 {
     GENERATED_BODY()
 
+    // Full world transform (includes scale)
     UPROPERTY()
-    float Time = 0.f;
+    FTransform World = FTransform::Identity;
+};
 
-    UPROPERTY()
-    TArray<FVector> Translations;
+// ------------------------------------------------------------
+// Bone mask
+// ------------------------------------------------------------
 
-    UPROPERTY()
-    TArray<FQuat> Rotations;
+/** Subset of a skeleton to record. See EMocapBoneMaskMode. */
+USTRUCT(BlueprintType)
+struct FMocapBoneMask
+{
+    GENERATED_BODY()
 
-#if WITH_EDITORONLY_DATA
-    UPROPERTY()
-    TArray<FVector> HeadWorld;
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mocap|Recording")
+    EMocapBoneMaskMode Mode = EMocapBoneMaskMode::All;
 
-    UPROPERTY()
-    TArray<FVector> TailWorld;
-#endif
+    /** Bone names for Include, Exclude and BranchRoots. Names the skeleton does not have are ignored with a warning. */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mocap|Recording")
+    TArray<FName> Bones;
+
+    bool IsAll() const { return Mode == EMocapBoneMaskMode::All; }
+
+    bool operator==(const FMocapBoneMask& Other) const { return Mode == Other.Mode && Bones == Other.Bones; }
+    bool operator!=(const FMocapBoneMask& Other) const { return !(*this == Other); }
 };
 
 // ------------------------------------------------------------
-// Transform-only capture (bullets/casings/props)
+// Skeleton topology (shared per skeletal mesh and bone mask)
 // ------------------------------------------------------------
-USTRUCT()
-struct FMocapTransformFrame
+
+/**
+ * Immutable layout of the bones a recorder captures, derived once from a skeletal mesh's reference skeleton.
+ * Shared by every recorder (and recorded take handed to a bake) that records the same mesh with the same bone mask.
+ *
+ * Arrays are indexed by topology bone index, which is also the take's bone index and the order of captured
+ * poses. Without a mask it equals the skeleton bone index; a masked topology is the recorded subset in
+ * skeleton order, itself a complete hierarchy (parents precede children), and SkeletonIndices maps back.
+ */
+struct FMocapSkeletonTopology
+{
+    /** First bone with no parent. */
+    int32 RootIndex = INDEX_NONE;
+
+    /** Parent bone index, INDEX_NONE for the root. */
+    TArray<int32> ParentIndices;
+
+    /** First child bone index, INDEX_NONE for leaves. Used for the editor tail position. */
+    TArray<int32> FirstChildIndices;
+
+    /** Bone names in recording order. */
+    TArray<FName> BoneNames;
+
+    /** Skeleton bone index for each recorded bone. */
+    TArray<int32> SkeletonIndices;
+
+    /** Bones in the source mesh's reference skeleton. */
+    int32 NumSkeletonBones = 0;
+
+    int32 Num() const { return BoneNames.Num(); }
+
+    /** True when only a subset of the skeleton is recorded (captured poses must be gathered through SkeletonIndices). */
+    bool IsMasked() const { return Num() != NumSkeletonBones; }
+};
+
+// ------------------------------------------------------------
+// Capture statistics
+// ------------------------------------------------------------
+struct FMocapCaptureStats
+{
+    /** Frames captured by SampleFrame (preroll padding excluded). */
+    int64 NumSamples = 0;
+
+    /** Heap allocations made by the recorder's own buffers (scratch + take) while sampling. */
+    int64 NumSampleAllocations = 0;
+
+    /** Captures that read the mesh's already-finalized pose. */
+    int64 NumFinalizedPoseReads = 0;
+
+    /** Captures that had to force TickAnimation/RefreshBoneTransforms because the pose was stale. */
+    int64 NumForcedEvaluations = 0;
+
+    double GetAllocationsPerSample() const
+    {
+        return NumSamples > 0 ? (double)NumSampleAllocations / (double)NumSamples : 0.0;
+    }
+};
+
+// ------------------------------------------------------------
+// Deferred pose conversion
+// ------------------------------------------------------------
+
+/**
+ * Game-thread copy of one evaluated pose, waiting to be converted into its reserved take frame.
+ * Owned per recorder and reused every sample, so steady-state snapshots do not allocate.
+ */
+struct FMocapPoseSnapshot
+{
+    TArray<FTransform> ComponentSpaceTransforms;
+    FTransform ComponentToWorld = FTransform::Identity;
+
+    /** Take frame reserved for this pose, or INDEX_NONE when nothing is pending. */
+    int32 FrameIndex = INDEX_NONE;
+};
+
+/** Reusable buffers for converting one component-space pose into take locals. */
+struct FMocapLocalPoseScratch
+{
+    TArray<FVector> LocalTranslations;
+    TArray<FQuat> LocalRotations;
+};
+
+// ------------------------------------------------------------
+// Sample-index timeline
+// ------------------------------------------------------------
+
+/**
+ * Maps a take's stored frames to session sample indices (integer ticks of the take's FFrameRate).
+ *
+ * A uniform take (stored frame f captured at FirstSampleIndex + f) stores nothing per frame. Explicit
+ * sample indices are only materialized once a sample is skipped (hitch), so steady captures carry no
+ * per-frame timestamps. Samples before the first stored frame hold that frame (late-start preroll).
+ */
+struct MOCAPRECORDER_API FMocapSampleTimeline
+{
+    void Reset();
+
+    /**
+     * Records the sample index of the next stored frame. INDEX_NONE means the sample after the last one.
+     * Sample indices must increase. Returns the new stored frame index.
+     */
+    int32 AddFrame(int64 SampleIndex = INDEX_NONE);
+
+    void RemoveLastFrame();
+
+    /** Moves a uniform timeline so its first stored frame sits at InFirstSampleIndex. */
+    void SetFirstSampleIndex(int64 InFirstSampleIndex);
+    int64 GetFirstSampleIndex() const { return FirstSampleIndex; }
+
+    /** Sample index the next AddFrame(INDEX_NONE) would use. */
+    int64 GetNextSampleIndex() const { return NumFrames > 0 ? GetSampleIndex(NumFrames - 1) + 1 : FirstSampleIndex; }
+
+    int64 GetSampleIndex(int32 FrameIndex) const
+    {
+        checkSlow(FrameIndex >= 0 && FrameIndex < NumFrames);
+        return SampleIndices.Num() > 0 ? SampleIndices[FrameIndex] : FirstSampleIndex + FrameIndex;
+    }
+
+    /** Stored frame holding at SampleIndex: the last frame captured at or before it, frame 0 before the first. */
+    int32 FindFrameAtSample(int64 SampleIndex) const;
+
+    /** Samples spanned from session sample 0 through the last stored frame. */
+    int64 GetNumSamples() const { return NumFrames > 0 ? GetSampleIndex(NumFrames - 1) + 1 : 0; }
+
+    int32 Num() const { return NumFrames; }
+    bool IsUniform() const { return SampleIndices.Num() == 0; }
+
+    SIZE_T GetAllocatedSize() const { return SampleIndices.GetAllocatedSize(); }
+
+private:
+    int64 FirstSampleIndex = 0;
+    int32 NumFrames = 0;
+
+    /** Empty while uniform; otherwise one entry per stored frame. */
+    TArray<int64> SampleIndices;
+};
+
+// ------------------------------------------------------------
+// Raw pose storage (EMocapPoseStorage::RawComponentSpace)
+// ------------------------------------------------------------
+
+/**
+ * Captured component-space poses awaiting derivation. Frames live in fixed chunks of FramesPerChunk frames,
+ * frame-major inside a chunk so appending a frame is one bulk copy and never relocates earlier frames.
+ * Bone order is skeleton bone index order. Frame indices are stored frames; the timeline gives their samples.
+ */
+struct MOCAPRECORDER_API FMocapRawTake
+{
+    static constexpr int32 FramesPerChunk = 256;
+
+    FMocapRawTake() = default;
+    FMocapRawTake(const FMocapRawTake& Other);
+    FMocapRawTake(FMocapRawTake&& Other);
+    FMocapRawTake& operator=(const FMocapRawTake& Other);
+    FMocapRawTake& operator=(FMocapRawTake&& Other);
+    ~FMocapRawTake();
+
+    /** Takes chunks from InPool (null: the heap). Releases the current frames. */
+    void SetChunkPool(TSharedPtr<FMocapTakeChunkPool> InPool);
+
+    /** Drops all frames and sets the bone count. Keeps the chunks when the bone count is unchanged. */
+    void Reset(int32 InNumBones);
+
+    /** Drops all frames and returns every chunk to the pool. */
+    void Empty();
+
+    /** Ensures room for at least InNumFrames frames without acquiring chunks. */
+    void Reserve(int32 InNumFrames);
+
+    /** Appends one frame (bulk copy) at SampleIndex (INDEX_NONE: the next sample). Returns the new frame index. */
+    int32 AddFrame(TConstArrayView<FTransform> InComponentSpace, const FTransform& InComponentToWorld, int64 SampleIndex = INDEX_NONE);
+
+    const FMocapSampleTimeline& GetTimeline() const { return Timeline; }
+    FMocapSampleTimeline& GetTimeline() { return Timeline; }
+
+    int32 Num() const { return NumFrames; }
+    int32 GetNumBones() const { return NumBones; }
+    bool IsEmpty() const { return NumFrames == 0; }
+
+    TConstArrayView<FTransform> GetComponentSpace(int32 FrameIndex) const
+    {
+        checkSlow(FrameIndex >= 0 && FrameIndex < NumFrames);
+        const FTransform* Chunk = Chunks[FrameIndex / FramesPerChunk];
+        return TConstArrayView<FTransform>(Chunk + (FrameIndex % FramesPerChunk) * NumBones, NumBones);
+    }
+
+    const FTransform& GetComponentToWorld(int32 FrameIndex) const
+    {
+        checkSlow(FrameIndex >= 0 && FrameIndex < NumFrames);
+        const FTransform* Chunk = Chunks[FrameIndex / FramesPerChunk];
+        return Chunk[FramesPerChunk * NumBones + FrameIndex % FramesPerChunk];
+    }
+
+    /** Bytes held by the chunks and timeline, including unused frames in the last chunk. */
+    SIZE_T GetAllocatedSize() const
+    {
+        return Chunks.Num() * GetChunkBytes() + Chunks.GetAllocatedSize() + Timeline.GetAllocatedSize();
+    }
+
+    /** Number of chunks acquired since construction. */
+    int32 GetNumAllocations() const { return NumAllocations; }
+
+private:
+    /** Per chunk: FramesPerChunk component-space poses, then FramesPerChunk component-to-world transforms. */
+    SIZE_T GetChunkBytes() const { return (SIZE_T)FramesPerChunk * (NumBones + 1) * sizeof(FTransform); }
+
+    void ReleaseChunks();
+    void CopyFrom(const FMocapRawTake& Other);
+
+    int32 NumBones = 0;
+    int32 NumFrames = 0;
+    int32 NumAllocations = 0;
+
+    FMocapSampleTimeline Timeline;
+
+    TSharedPtr<FMocapTakeChunkPool> ChunkPool;
+    TArray<FTransform*> Chunks;
+};
+
+// ------------------------------------------------------------
+// Take compression
+// ------------------------------------------------------------
+
+/**
+ * Optional lossy encoding of full-track take chunks, for sessions too large to keep as float samples.
+ * A chunk is encoded once all of its frames are written: rotations as 48-bit smallest-three quaternions,
+ * translations as 16 bits per axis quantized against that chunk's min/max. A chunk whose reconstruction
+ * would exceed the error budget stays uncompressed.
+ */
+USTRUCT(BlueprintType)
+struct FMocapTakeCompression
 {
     GENERATED_BODY()
 
-    UPROPERTY()
-    float Time = 0.f;
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mocap|Recording")
+    bool bEnabled = false;
 
-    // Full world transform (includes scale)
-    UPROPERTY()
-    FTransform World = FTransform::Identity;
+    /** Largest translation error (cm) an encoded chunk may introduce. */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mocap|Recording", meta = (ClampMin = "0"))
+    float TranslationErrorBudget = 0.05f;
+
+    /** Largest rotation error (degrees) an encoded chunk may introduce. */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mocap|Recording", meta = (ClampMin = "0"))
+    float RotationErrorBudgetDegrees = 0.01f;
+};
+
+/** What compression achieved on one take. Errors are measured against the float samples each chunk replaced. */
+struct FMocapTakeCompressionStats
+{
+    int32 NumEncodedChunks = 0;
+
+    /** Complete chunks kept as floats because encoding them would have exceeded the error budget. */
+    int32 NumOverBudgetChunks = 0;
+
+    float MaxTranslationError = 0.f;
+    float MaxRotationErrorDegrees = 0.f;
+
+    /** Adds Other's counts and keeps the larger errors (merging per-channel or per-take stats). */
+    void Accumulate(const FMocapTakeCompressionStats& Other)
+    {
+        NumEncodedChunks += Other.NumEncodedChunks;
+        NumOverBudgetChunks += Other.NumOverBudgetChunks;
+        MaxTranslationError = FMath::Max(MaxTranslationError, Other.MaxTranslationError);
+        MaxRotationErrorDegrees = FMath::Max(MaxRotationErrorDegrees, Other.MaxRotationErrorDegrees);
+    }
+};
+
+// ------------------------------------------------------------
+// Take storage (structure-of-arrays)
+// ------------------------------------------------------------
+
+/** One full-track chunk: FramesPerChunk float samples, or once encoded, FramesPerChunk 48-bit samples (3 x uint16). */
+struct FMocapTakeChunk
+{
+    void* Data = nullptr;
+
+    /** Encoded translation chunks: axis value = RangeMin + Quantized * RangeStep. */
+    FVector3f RangeMin = FVector3f::ZeroVector;
+    FVector3f RangeStep = FVector3f::ZeroVector;
+
+    bool bEncoded = false;
+};
+
+/**
+ * One bone channel of a take: a single constant until a sample deviates from it, then a full track stored
+ * in fixed chunks of FMocapTake::FramesPerChunk samples.
+ */
+template <typename SampleType>
+struct TMocapTakeChannel
+{
+    /** First sample; the value of every frame while the channel is constant. */
+    SampleType Constant;
+
+    /** Full track chunks, empty while constant. */
+    TArray<FMocapTakeChunk> Chunks;
+
+    bool IsConstant() const { return Chunks.Num() == 0; }
+};
+
+/**
+ * One recorded take, stored structure-of-arrays: one channel per bone for translations and one for rotations.
+ *
+ * Channels that stay within tolerance of their first sample (most bone translations, IK helpers, sockets,
+ * unused twist bones) are kept as a single constant and promote to a full track the first time a sample
+ * deviates. Full tracks live in fixed chunks of FramesPerChunk samples, so appending a frame never relocates
+ * recorded samples and walking one bone across all frames (what the bake does) reads one linear run per chunk.
+ * Chunks come from an optional FMocapTakeChunkPool shared by the session, and go back to it when the take is
+ * reset or destroyed. Head/tail positions are derived on demand, never stored.
+ *
+ * Samples are stored as 32-bit floats (the precision the baked tracks have). The root bone's translation,
+ * the only one that can be far from zero, is stored relative to a double-precision per-take origin so
+ * large-world positions still reconstruct exactly. With compression enabled, each full-track chunk is encoded
+ * as soon as it is complete (on whichever thread writes its last frame); the open tail chunk stays float.
+ * Out-of-order writers leave encoding to EncodeCompleteChunks, which encodes the channels in parallel.
+ * Readers only ever see decoded samples.
+ *
+ * Frames carry no timestamps: each one's time is its timeline sample index at the take's exact SampleRate.
+ * Online capture writes frames in order; writers that fill frames out of order (in parallel) call
+ * PromoteAllChannels first and CompactConstantChannels after.
+ */
+struct MOCAPRECORDER_API FMocapTake
+{
+    static constexpr int32 FramesPerChunk = 256;
+
+    /** Default constant-channel tolerances: 0.001 cm, and 0.0001 rad of rotation. */
+    static constexpr float DefaultTranslationTolerance = 1e-3f;
+    static constexpr float DefaultRotationTolerance = 1e-4f;
+
+    FMocapTake() = default;
+    FMocapTake(const FMocapTake& Other);
+    FMocapTake(FMocapTake&& Other);
+    FMocapTake& operator=(const FMocapTake& Other);
+    FMocapTake& operator=(FMocapTake&& Other);
+    ~FMocapTake();
+
+    /** Takes chunks from InPool (null: the heap). Releases the current frames. */
+    void SetChunkPool(TSharedPtr<FMocapTakeChunkPool> InPool);
+
+    /**
+     * Drops all frames, sets the bone count and the bone whose translation is origin-relative, and clears the origin.
+     * Every channel starts out constant.
+     */
+    void Reset(int32 InNumBones, int32 InRootBoneIndex = 0);
+
+    /** Drops all frames and returns every chunk to the pool. */
+    void Empty();
+
+    /** Reserves chunk bookkeeping for InFrameCapacity frames. Chunks themselves are acquired as tracks need them. */
+    void Reserve(int32 InFrameCapacity);
+
+    /** How far a sample may drift from a constant channel's value before the channel becomes a full track. */
+    void SetConstantTolerances(float InTranslationTolerance, float InRotationToleranceRadians);
+
+    /** Sets the root translation origin. Only before the first frame is written (stored samples are relative to it). */
+    void SetTranslationOrigin(const FVector& InOrigin) { checkSlow(NumFrames == 0); TranslationOrigin = InOrigin; }
+    const FVector& GetTranslationOrigin() const { return TranslationOrigin; }
+    int32 GetRootBoneIndex() const { return RootBoneIndex; }
+
+    /**
+     * Appends one frame with unset samples at SampleIndex (INDEX_NONE: the next sample) and returns its index.
+     * Fill it with SetBoneSample.
+     */
+    int32 AddFrameUninitialized(int64 SampleIndex = INDEX_NONE);
+
+    /** Drops the most recently appended frame (used when a capture into it fails). */
+    void RemoveLastFrame();
+
+    /** Writes one bone sample. A constant channel absorbs it if within tolerance, otherwise it becomes a full track. */
+    void SetBoneSample(int32 FrameIndex, int32 BoneIndex, const FVector& Translation, const FQuat& Rotation);
+
+    /**
+     * Turns every constant channel into a full track so frames can be written in any order, e.g. in parallel.
+     * Chunk encoding is deferred until EncodeCompleteChunks.
+     */
+    void PromoteAllChannels();
+
+    /** Turns full tracks that stayed within tolerance of their first sample back into constants. */
+    void CompactConstantChannels();
+
+    /**
+     * Encodes every complete chunk not yet encoded (after out-of-order writes) and resumes online encoding.
+     * Channels are encoded in parallel; each touches only its own chunks.
+     */
+    void EncodeCompleteChunks();
+
+    /** Applies to chunks completed from now on. */
+    void SetCompression(const FMocapTakeCompression& InCompression);
+    const FMocapTakeCompression& GetCompression() const { return Compression; }
+    const FMocapTakeCompressionStats& GetCompressionStats() const { return CompressionStats; }
+
+    void SetSampleRate(const FFrameRate& InSampleRate) { SampleRate = InSampleRate; }
+    const FFrameRate& GetSampleRate() const { return SampleRate; }
+
+    const FMocapSampleTimeline& GetTimeline() const { return Timeline; }
+    FMocapSampleTimeline& GetTimeline() { return Timeline; }
+
+    int32 Num() const { return NumFrames; }
+    int32 GetNumBones() const { return NumBones; }
+    bool IsEmpty() const { return NumFrames == 0; }
+
+    bool IsTranslationConstant(int32 BoneIndex) const { return Translations[BoneIndex].IsConstant(); }
+    bool IsRotationConstant(int32 BoneIndex) const { return Rotations[BoneIndex].IsConstant(); }
+
+    /** Channels (translation and rotation per bone) currently stored as a single constant. */
+    int32 GetNumConstantChannels() const;
+
+    /** Full-precision sample (root translation re-applies the origin in double). */
+    FVector GetTranslation(int32 BoneIndex, int32 FrameIndex) const
+    {
+        const FVector Stored(GetStoredTranslation(BoneIndex, FrameIndex));
+        return BoneIndex == RootBoneIndex ? Stored + TranslationOrigin : Stored;
+    }
+
+    FQuat GetRotation(int32 BoneIndex, int32 FrameIndex) const { return FQuat(GetRotation4f(BoneIndex, FrameIndex)); }
+
+    /** Track-precision sample, as the bake keys it. Only the root bone goes through double. */
+    FVector3f GetTranslation3f(int32 BoneIndex, int32 FrameIndex) const
+    {
+        return BoneIndex == RootBoneIndex ? FVector3f(GetTranslation(BoneIndex, FrameIndex)) : GetStoredTranslation(BoneIndex, FrameIndex);
+    }
+
+    FQuat4f GetRotation4f(int32 BoneIndex, int32 FrameIndex) const { return GetSample(Rotations[BoneIndex], FrameIndex); }
+
+    /** Bytes held by the chunks (encoded or not), channel bookkeeping and timeline, including unused samples in the last chunks. */
+    SIZE_T GetAllocatedSize() const;
+
+    /** Number of chunks acquired since construction. */
+    int32 GetNumAllocations() const { return NumAllocations; }
+
+private:
+    static constexpr SIZE_T EncodedChunkBytes = FramesPerChunk * 3 * sizeof(uint16);
+
+    FVector3f GetStoredTranslation(int32 BoneIndex, int32 FrameIndex) const { return GetSample(Translations[BoneIndex], FrameIndex); }
+
+    template <typename SampleType>
+    SampleType GetSample(const TMocapTakeChannel<SampleType>& Channel, int32 FrameIndex) const
+    {
+        checkSlow(FrameIndex >= 0 && FrameIndex < NumFrames);
+        if (Channel.IsConstant())
+        {
+            return Channel.Constant;
+        }
+
+        const FMocapTakeChunk& Chunk = Channel.Chunks[FrameIndex / FramesPerChunk];
+        if (Chunk.bEncoded)
+        {
+            SampleType Sample;
+            DecodeSample(Chunk, FrameIndex % FramesPerChunk, Sample);
+            return Sample;
+        }
+        return static_cast<const SampleType*>(Chunk.Data)[FrameIndex % FramesPerChunk];
+    }
+
+    static void DecodeSample(const FMocapTakeChunk& Chunk, int32 Sample, FVector3f& OutTranslation);
+    static void DecodeSample(const FMocapTakeChunk& Chunk, int32 Sample, FQuat4f& OutRotation);
+
+    template <typename SampleType>
+    static SIZE_T GetChunkBytes(const FMocapTakeChunk& Chunk) { return Chunk.bEncoded ? EncodedChunkBytes : FramesPerChunk * sizeof(SampleType); }
+
+    /** Writes a full-track sample, decoding its chunk back to floats first if it was already encoded. */
+    template <typename SampleType>
+    void WriteSample(TMocapTakeChannel<SampleType>& Channel, int32 FrameIndex, const SampleType& Value);
+
+    /** Online encoding after FrameIndex was written: encodes the chunks that write (or a promotion) completed. */
+    template <typename SampleType>
+    void EncodeCompletedChunks(TMocapTakeChannel<SampleType>& Channel, int32 FrameIndex, bool bPromoted);
+
+    /**
+     * Replaces a float chunk with its encoding if the reconstruction is within budget. Results and chunk
+     * acquisitions go to Stats / InOutNumAllocations, so parallel encoders can each count into their own.
+     */
+    void EncodeChunk(TMocapTakeChannel<FVector3f>& Channel, int32 ChunkIndex, FMocapTakeCompressionStats& Stats, int32& InOutNumAllocations) const;
+    void EncodeChunk(TMocapTakeChannel<FQuat4f>& Channel, int32 ChunkIndex, FMocapTakeCompressionStats& Stats, int32& InOutNumAllocations) const;
+
+    /** Swaps Chunk's float samples for Encoded (EncodedChunkBytes). */
+    template <typename SampleType>
+    void CommitEncodedChunk(FMocapTakeChunk& Chunk, void* Encoded, FMocapTakeCompressionStats& Stats) const;
+
+    /** Encodes Channel's complete chunks that are not encoded yet. */
+    template <typename SampleType>
+    void EncodeChannelCompleteChunks(TMocapTakeChannel<SampleType>& Channel, FMocapTakeCompressionStats& Stats, int32& InOutNumAllocations) const;
+
+    template <typename SampleType>
+    void DecodeChunk(FMocapTakeChunk& Chunk);
+
+    template <typename SampleType>
+    void AddChunk(TMocapTakeChannel<SampleType>& Channel);
+
+    /** Gives a constant channel chunks for every current frame, filled with its constant. */
+    template <typename SampleType>
+    void PromoteChannel(TMocapTakeChannel<SampleType>& Channel);
+
+    template <typename SampleType>
+    void ReleaseChannel(TMocapTakeChannel<SampleType>& Channel);
+
+    template <typename SampleType>
+    void CompactChannel(TMocapTakeChannel<SampleType>& Channel);
+
+    template <typename SampleType>
+    void CopyChannel(TMocapTakeChannel<SampleType>& Channel, const TMocapTakeChannel<SampleType>& OtherChannel);
+
+    bool IsWithinTolerance(const FVector3f& A, const FVector3f& B) const;
+    bool IsWithinTolerance(const FQuat4f& A, const FQuat4f& B) const;
+
+    void ReleaseChunks();
+    void CopyFrom(const FMocapTake& Other);
+
+    int32 NumBones = 0;
+    int32 NumFrames = 0;
+    int32 NumAllocations = 0;
+
+    /** Bone whose translation is stored relative to TranslationOrigin. */
+    int32 RootBoneIndex = 0;
+    FVector TranslationOrigin = FVector::ZeroVector;
+
+    float TranslationToleranceSquared = DefaultTranslationTolerance * DefaultTranslationTolerance;
+
+    /**
+     * Squared quaternion distance (sign-aligned) of the rotation tolerance: (angle / 2)^2 for small angles.
+     * Compared on component differences, which stay precise in float where a dot product near 1 would not.
+     */
+    float RotationToleranceSquared = 0.25f * DefaultRotationTolerance * DefaultRotationTolerance;
+
+    FFrameRate SampleRate = FFrameRate(60, 1);
+    FMocapSampleTimeline Timeline;
+
+    FMocapTakeCompression Compression;
+    FMocapTakeCompressionStats CompressionStats;
+
+    /** Set by PromoteAllChannels: frames may be written in any order, so no chunk is known to be complete. */
+    bool bDeferEncoding = false;
+
+    TSharedPtr<FMocapTakeChunkPool> ChunkPool;
+    TArray<TMocapTakeChannel<FVector3f>> Translations;
+    TArray<TMocapTakeChannel<FQuat4f>> Rotations;
+};
+
+// ------------------------------------------------------------
+// Detached take (bake input)
+// ------------------------------------------------------------
+
+/**
+ * One finished recording detached from its recorder: everything a bake needs, as plain data the garbage
+ * collector never sees. Assets are soft references. The take data is moved out of the recorder, never copied,
+ * and its chunks go back to the session pool when this is destroyed.
+ */
+struct MOCAPRECORDER_API FMocapRecordedTake
+{
+    TSoftObjectPtr<USkeleton> Skeleton;
+    TSoftObjectPtr<USkeletalMesh> MeshAsset;
+
+    /** Bone layout of the take (shared per mesh and bone mask). */
+    TSharedPtr<const FMocapSkeletonTopology> Topology;
+
+    FMocapTake Take;
+
+    /** Raw component-space poses (EMocapPoseStorage::RawComponentSpace) until ResolveRawCapture derives Take. */
+    FMocapRawTake RawTake;
+
+    /** Transform-only captures. */
+    TArray<FMocapTransformFrame> TransformFrames;
+
+    EMocapCaptureMode CaptureMode = EMocapCaptureMode::Skeletal;
+    FFrameRate SampleRate = FFrameRate(60, 1);
+    FTransform WorldBakeBaselineRoot = FTransform::Identity;
+
+    /** Recorded actor's name, for logs: the actor is usually gone by the time the take is baked. */
+    FString SourceName;
+
+    bool IsTransformOnly() const { return CaptureMode == EMocapCaptureMode::TransformOnly; }
+
+    /** Stored frames, raw or derived. */
+    int32 GetNumRecordedFrames() const;
+
+    const TArray<FName>& GetBoneNames() const;
+
+    /** Bytes held by the take data. */
+    SIZE_T GetAllocatedSize() const
+    {
+        return Take.GetAllocatedSize() + RawTake.GetAllocatedSize() + TransformFrames.GetAllocatedSize();
+    }
+
+    /** Derives Take from the raw poses (parallel over frames), then releases them. No-op for derived captures. */
+    void ResolveRawCapture();
 };
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+
+/** Byte counters for one chunk pool. Snapshot values. */
+struct FMocapTakeChunkPoolStats
+{
+    /** Bytes in chunks currently owned by takes. */
+    uint64 LiveBytes = 0;
+
+    /** Highest LiveBytes seen since construction (or the last ResetPeak). */
+    uint64 PeakLiveBytes = 0;
+
+    /** Bytes in free chunks kept for reuse. */
+    uint64 PooledBytes = 0;
+
+    /** Chunks served from the heap vs. recycled from the free lists. */
+    int64 NumHeapAllocations = 0;
+    int64 NumReuses = 0;
+};
+
+/**
+ * Arena of fixed-size take chunks shared by every recorder of a capture session.
+ *
+ * Takes are built from chunks of a fixed number of frames, so appending never relocates recorded data.
+ * Released chunks go onto a free list keyed by their size (one size per skeleton) and are handed to the
+ * next take that needs one, so a new session reuses the previous session's memory instead of the heap.
+ * Free chunks above MaxPooledBytes are returned to the heap.
+ *
+ * Thread-safe: takes are appended on pipeline and commit workers.
+ */
+class MOCAPRECORDER_API FMocapTakeChunkPool
+{
+public:
+    explicit FMocapTakeChunkPool(uint64 InMaxPooledBytes = 512ull * 1024 * 1024);
+    ~FMocapTakeChunkPool();
+
+    FMocapTakeChunkPool(const FMocapTakeChunkPool&) = delete;
+    FMocapTakeChunkPool& operator=(const FMocapTakeChunkPool&) = delete;
+
+    /** Returns a chunk of exactly NumBytes (16-byte aligned), recycled when one is free. */
+    void* Allocate(SIZE_T NumBytes);
+
+    /** Hands a chunk obtained from Allocate back to the pool. */
+    void Release(void* Chunk, SIZE_T NumBytes);
+
+    /** Frees every pooled chunk. Chunks owned by takes are unaffected. */
+    void Trim();
+
+    void ResetPeak();
+
+    FMocapTakeChunkPoolStats GetStats() const;
+
+    /**
+     * Chunk helpers for takes that may or may not have a pool: without one, chunks come straight from the heap.
+     */
+    static void* AllocateChunk(FMocapTakeChunkPool* Pool, SIZE_T NumBytes);
+    static void ReleaseChunk(FMocapTakeChunkPool* Pool, void* Chunk, SIZE_T NumBytes);
+
+private:
+    mutable FCriticalSection Mutex;
+
+    /** Free chunks by size in bytes. */
+    TMap<SIZE_T, TArray<void*>> FreeChunks;
+
+    uint64 MaxPooledBytes = 0;
+    FMocapTakeChunkPoolStats Stats;
+};
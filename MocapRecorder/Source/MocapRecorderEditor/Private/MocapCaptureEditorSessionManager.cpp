@@ -6,7 +6,13 @@
 #include "TimerManager.h"
 #include "Containers/Ticker.h"
 #include "Misc/ScopedSlowTask.h"
+#include "Async/ParallelFor.h"
+#include "Engine/Engine.h"
 #include "Engine/EngineTypes.h"
+#include "Engine/World.h"
+#include "Engine/Level.h"
+#include "HAL/PlatformTime.h"
+#include "UObject/UObjectGlobals.h"
 
 // Gameplay helpers used in this file
 #include "Kismet/GameplayStatics.h"
@@ -20,6 +26,8 @@
 #include "MocapRecorderComponent.h"
 #include "MocapRecorderEditorModule.h"
 #include "MocapCaptureMode.h"
+#include "MocapCapturePipeline.h"
+#include "MocapTakeChunkPool.h"
 #include "Misc/Optional.h"
 
 
@@ -47,6 +55,15 @@ static bool ExportMeshAssetToFbx_IfMissing(const FString& MeshAssetPath, FString
 // IWYU: include what you use; do not rely on transitive includes.
 
 
+namespace
+{
+    // Sweep: the clock is read once per this many visited actors.
+    constexpr int32 MocapSweepClockInterval = 64;
+
+    // Pending auto-capture: how long a rule-matching actor may wait for its skeletal mesh before it is dropped.
+    constexpr double MocapPendingMeshTimeoutSeconds = 2.0;
+}
+
 static const TCHAR* SESSIONMANAGER_FINGERPRINT = TEXT("MocapSession: VERSION_FINGERPRINT 2026-01-31 SESSIONMANAGER_SYNC_A");
 
 void UMocapCaptureEditorSessionManager::Initialize(UWorld* InWorld)
@@ -62,6 +79,22 @@ void UMocapCaptureEditorSessionManager::Initialize(UWorld* InWorld)
         EndPIEHandle = FEditorDelegates::EndPIE.AddUObject(this, &UMocapCaptureEditorSessionManager::OnEndPIE);
     }
 
+    if (!ObjectsReplacedHandle.IsValid())
+    {
+        ObjectsReplacedHandle = FCoreUObjectDelegates::OnObjectsReplaced.AddUObject(this, &UMocapCaptureEditorSessionManager::OnObjectsReplaced);
+    }
+
+    if (GEngine && !LevelActorAddedHandle.IsValid())
+    {
+        LevelActorAddedHandle = GEngine->OnLevelActorAdded().AddUObject(this, &UMocapCaptureEditorSessionManager::OnLevelActorAddedOrDeleted);
+        LevelActorDeletedHandle = GEngine->OnLevelActorDeleted().AddUObject(this, &UMocapCaptureEditorSessionManager::OnLevelActorAddedOrDeleted);
+    }
+    if (!GuidIndexLevelAddedHandle.IsValid())
+    {
+        GuidIndexLevelAddedHandle = FWorldDelegates::LevelAddedToWorld.AddUObject(this, &UMocapCaptureEditorSessionManager::OnActorGuidIndexLevelChanged);
+        GuidIndexLevelRemovedHandle = FWorldDelegates::LevelRemovedFromWorld.AddUObject(this, &UMocapCaptureEditorSessionManager::OnActorGuidIndexLevelChanged);
+    }
+
     ResolveTargetsForWorld(World);
 }
 
@@ -79,6 +112,28 @@ void UMocapCaptureEditorSessionManager::BeginDestroy()
         EndPIEHandle.Reset();
     }
 
+    if (ObjectsReplacedHandle.IsValid())
+    {
+        FCoreUObjectDelegates::OnObjectsReplaced.Remove(ObjectsReplacedHandle);
+        ObjectsReplacedHandle.Reset();
+    }
+
+    if (GEngine && LevelActorAddedHandle.IsValid())
+    {
+        GEngine->OnLevelActorAdded().Remove(LevelActorAddedHandle);
+        GEngine->OnLevelActorDeleted().Remove(LevelActorDeletedHandle);
+    }
+    LevelActorAddedHandle.Reset();
+    LevelActorDeletedHandle.Reset();
+
+    if (GuidIndexLevelAddedHandle.IsValid())
+    {
+        FWorldDelegates::LevelAddedToWorld.Remove(GuidIndexLevelAddedHandle);
+        FWorldDelegates::LevelRemovedFromWorld.Remove(GuidIndexLevelRemovedHandle);
+        GuidIndexLevelAddedHandle.Reset();
+        GuidIndexLevelRemovedHandle.Reset();
+    }
+
     if (PostPIEBakeKickHandle.IsValid())
     {
         FTSTicker::GetCoreTicker().RemoveTicker(PostPIEBakeKickHandle);
@@ -86,6 +141,12 @@ void UMocapCaptureEditorSessionManager::BeginDestroy()
     }
 
 
+    if (WorldPostActorTickHandle.IsValid())
+    {
+        FWorldDelegates::OnWorldPostActorTick.Remove(WorldPostActorTickHandle);
+        WorldPostActorTickHandle.Reset();
+    }
+
     UnbindSpawnHook();
     EndBakeQueue();
 
@@ -175,20 +236,68 @@ FString UMocapCaptureEditorSessionManager::MakeDefaultAssetName(AActor* Actor)
 
 AActor* UMocapCaptureEditorSessionManager::FindActorByGuid(UWorld* InWorld, const FGuid& Guid)
 {
-#if WITH_EDITOR
     if (!InWorld || !Guid.IsValid())
         return nullptr;
 
+    if (!bActorGuidIndexValid || ActorGuidIndexWorld.Get() != InWorld)
+    {
+        BuildActorGuidIndex(InWorld);
+    }
+
+    const TWeakObjectPtr<AActor>* Found = ActorByGuid.Find(Guid);
+    AActor* A = Found ? Found->Get() : nullptr;
+    return IsValid(A) ? A : nullptr;
+}
+
+void UMocapCaptureEditorSessionManager::BuildActorGuidIndex(UWorld* InWorld)
+{
+    const double StartSeconds = FPlatformTime::Seconds();
+
+    ActorByGuid.Reset();
+    ActorGuidIndexWorld = InWorld;
+    bActorGuidIndexValid = true;
+
+#if WITH_EDITOR
     for (TActorIterator<AActor> It(InWorld); It; ++It)
     {
         AActor* A = *It;
-        if (A && A->GetActorGuid() == Guid)
+        if (!A)
+            continue;
+
+        // First actor wins on a duplicate GUID, as the linear search did.
+        TWeakObjectPtr<AActor>& Slot = ActorByGuid.FindOrAdd(A->GetActorGuid());
+        if (!Slot.IsValid())
         {
-            return A;
+            Slot = A;
         }
     }
 #endif
-    return nullptr;
+
+    UE_LOG(LogMocapRecorderEditor, Verbose, TEXT("Resolve: Indexed %d actor GUIDs in %s (%.2f ms)."),
+        ActorByGuid.Num(), *GetNameSafe(InWorld), (FPlatformTime::Seconds() - StartSeconds) * 1000.0);
+}
+
+void UMocapCaptureEditorSessionManager::InvalidateActorGuidIndex()
+{
+    // Lazy: the next lookup rebuilds, so a burst of spawns or deletes costs nothing until targets resolve.
+    bActorGuidIndexValid = false;
+    ActorByGuid.Reset();
+}
+
+void UMocapCaptureEditorSessionManager::OnLevelActorAddedOrDeleted(AActor* Actor)
+{
+    if (bActorGuidIndexValid && Actor && Actor->GetWorld() == ActorGuidIndexWorld.Get())
+    {
+        InvalidateActorGuidIndex();
+    }
+}
+
+void UMocapCaptureEditorSessionManager::OnActorGuidIndexLevelChanged(ULevel* Level, UWorld* InWorld)
+{
+    if (bActorGuidIndexValid && InWorld == ActorGuidIndexWorld.Get())
+    {
+        InvalidateActorGuidIndex();
+    }
 }
 
 void UMocapCaptureEditorSessionManager::ResolveTargetsForWorld(UWorld* InWorld)
@@ -274,6 +383,14 @@ void UMocapCaptureEditorSessionManager::SetTargetEnabled(int32 Index, bool bEnab
     }
 }
 
+void UMocapCaptureEditorSessionManager::SetTargetBoneMask(int32 Index, const FMocapBoneMask& InMask)
+{
+    if (Targets.IsValidIndex(Index))
+    {
+        Targets[Index].BoneMask = InMask;
+    }
+}
+
 // ------------------------------------------------------------
 // Class Rule API (called by panel)
 // ------------------------------------------------------------
@@ -282,27 +399,32 @@ void UMocapCaptureEditorSessionManager::AddClassRule()
 {
     FMocapClassCaptureRule NewRule;
     ClassRules.Add(NewRule);
+    CompileRuleMatcher();
 }
 
 void UMocapCaptureEditorSessionManager::RemoveClassRule(int32 Index)
 {
     if (ClassRules.IsValidIndex(Index))
         ClassRules.RemoveAt(Index);
+    CompileRuleMatcher();
 }
 
 void UMocapCaptureEditorSessionManager::ClearClassRules()
 {
     ClassRules.Reset();
+    CompileRuleMatcher();
 }
 
 void UMocapCaptureEditorSessionManager::SetClassRuleEnabled(int32 Index, bool bEnabled)
 {
     if (ClassRules.IsValidIndex(Index)) ClassRules[Index].bEnabled = bEnabled;
+    CompileRuleMatcher();
 }
 
 void UMocapCaptureEditorSessionManager::SetClassRuleClass(int32 Index, UClass* InClass)
 {
     if (ClassRules.IsValidIndex(Index)) ClassRules[Index].ActorClass = InClass;
+    CompileRuleMatcher();
 }
 
 void UMocapCaptureEditorSessionManager::SetClassRuleRequiredTag(int32 Index, FName InTag)
@@ -365,6 +487,11 @@ void UMocapCaptureEditorSessionManager::SetRule_AutoBakeOnAutoStop(int32 Index,
     if (ClassRules.IsValidIndex(Index)) ClassRules[Index].AutoStop.bAutoBakeOnAutoStop = bIn;
 }
 
+void UMocapCaptureEditorSessionManager::SetRule_BoneMask(int32 Index, const FMocapBoneMask& InMask)
+{
+    if (ClassRules.IsValidIndex(Index)) ClassRules[Index].BoneMask = InMask;
+}
+
 // ------------------------------------------------------------
 // Recorder attach
 // ------------------------------------------------------------
@@ -434,19 +561,22 @@ bool UMocapCaptureEditorSessionManager::StartSession()
     {
         const FMocapClassCaptureRule& R = ClassRules[i];
         UE_LOG(LogMocapRecorderEditor, Warning,
-            TEXT("  Rule[%d] Enabled=%d Class=%s TransformOnly=%d RequireSkel=%d Tag=%s"),
+            TEXT("  Rule[%d] Enabled=%d Class=%s TransformOnly=%d RequireSkel=%d Tag=%s BoneMask=%s(%d)"),
             i,
             R.bEnabled ? 1 : 0,
             *GetNameSafe(R.ActorClass.Get()),
             R.bTransformOnly ? 1 : 0,
             R.bRequireSkeletalMesh ? 1 : 0,
-            *R.RequiredTag.ToString());
+            *R.RequiredTag.ToString(),
+            *UEnum::GetValueAsString(R.BoneMask.Mode),
+            R.BoneMask.Bones.Num());
     }
 
     // Reset per-session tracking ONCE (and do NOT log "StopSession" strings here)
     SeenAutoCaptureActors.Reset();
     PendingAutoCaptureActors.Reset();
-    ActiveInstances.Reset();
+    PendingMeshDeadlines.Reset();
+    ResetActiveInstances();
 
     // Load rules BEFORE we tick so OnActorSpawned can match immediately
     for (FMocapClassCaptureRule& Rule : ClassRules)
@@ -456,9 +586,24 @@ bool UMocapCaptureEditorSessionManager::StartSession()
             Rule.ActorClass.LoadSynchronous();
         }
     }
+    CompileRuleMatcher();
 
     int32 StartedManual = 0;
 
+    // The async pipeline only serves timer sampling. Finalized sampling converts inline from each mesh's finalize
+    // callback; samples a hitch skips are recorded as timeline gaps, not filled.
+    if (bAsyncCapturePipeline && SamplingMode == EMocapSessionSamplingMode::Timer)
+    {
+        CapturePipeline = MakeShared<FMocapCapturePipeline>(CapturePipelineCapacity);
+    }
+
+    if (!TakeChunkPool)
+    {
+        TakeChunkPool = MakeShared<FMocapTakeChunkPool>();
+    }
+    TakeChunkPool->ResetPeak();
+    BakedCompressionStats = FMocapTakeCompressionStats();
+
     // Start manual targets
     for (FMocapEditorSessionTarget& T : Targets)
     {
@@ -476,9 +621,25 @@ bool UMocapCaptureEditorSessionManager::StartSession()
         if (!IsValid(Recorder))
             continue;
 
+        if (PoseStorage.IsSet())
+        {
+            Recorder->PoseStorage = PoseStorage.GetValue();
+        }
+        if (TakeCompression.IsSet())
+        {
+            Recorder->TakeCompression = TakeCompression.GetValue();
+        }
+        Recorder->BoneMask = T.BoneMask;
+        Recorder->SetTakeChunkPool(TakeChunkPool);
         Recorder->StartRecording_External();
+        Recorder->SetCapturePipeline(CapturePipeline);
         T.Recorder = Recorder;
         ++StartedManual;
+
+        if (SamplingMode == EMocapSessionSamplingMode::BoneTransformsFinalized)
+        {
+            T.BoneTransformsFinalizedHandle = BindFinalizedSampling(T.SkelComp.Get(), Recorder);
+        }
     }
 
     UE_LOG(LogMocapRecorderEditor, Warning, TEXT("Session: Started manual targets=%d"), StartedManual);
@@ -486,13 +647,24 @@ bool UMocapCaptureEditorSessionManager::StartSession()
     const float Interval = 1.f / FMath::Max(1.f, CaptureSampleRateHz);
 
     bIsRecording = true;
+    SessionStartTimeSeconds = World->GetTimeSeconds();
 
     // Start ticking + bind spawn hook
-    World->GetTimerManager().SetTimer(SessionTimerHandle, this, &UMocapCaptureEditorSessionManager::SampleAll, Interval, true);
+    if (SamplingMode == EMocapSessionSamplingMode::BoneTransformsFinalized)
+    {
+        // Recorders capture from their own OnBoneTransformsFinalized; discovery and auto-stop run once per world tick.
+        WorldPostActorTickHandle = FWorldDelegates::OnWorldPostActorTick.AddUObject(this, &UMocapCaptureEditorSessionManager::OnWorldPostActorTick);
+    }
+    else
+    {
+        World->GetTimerManager().SetTimer(SessionTimerHandle, this, &UMocapCaptureEditorSessionManager::SampleAll, Interval, true);
+    }
     BindSpawnHook();
+    BeginAutoCaptureDiscovery();
 
-    UE_LOG(LogMocapRecorderEditor, Warning, TEXT("Session: StartSession summary World=%s Interval=%f"),
-        *GetNameSafe(World), Interval);
+    UE_LOG(LogMocapRecorderEditor, Warning, TEXT("Session: StartSession summary World=%s Interval=%f Sampling=%s"),
+        *GetNameSafe(World), Interval,
+        SamplingMode == EMocapSessionSamplingMode::BoneTransformsFinalized ? TEXT("BoneTransformsFinalized") : TEXT("Timer"));
 
     return true;
 }
@@ -514,6 +686,12 @@ void UMocapCaptureEditorSessionManager::StopSession()
         World->GetTimerManager().ClearTimer(SessionTimerHandle);
     }
 
+    if (WorldPostActorTickHandle.IsValid())
+    {
+        FWorldDelegates::OnWorldPostActorTick.Remove(WorldPostActorTickHandle);
+        WorldPostActorTickHandle.Reset();
+    }
+
     // Unbind spawn hook once
     UnbindSpawnHook();
     UE_LOG(LogMocapRecorderEditor, Warning, TEXT("Session: Spawn hook unbound."));
@@ -530,6 +708,8 @@ void UMocapCaptureEditorSessionManager::StopSession()
             continue;
         }
 
+        UnbindFinalizedSampling(T.SkelComp.Get(), T.BoneTransformsFinalizedHandle);
+
         UMocapRecorderComponent* Recorder = T.Recorder.Get();
         if (!IsValid(Recorder))
         {
@@ -542,7 +722,7 @@ void UMocapCaptureEditorSessionManager::StopSession()
             Recorder->StopRecording_External();
         }
 
-        const int32 NumFrames = Recorder->GetRecordedFrames().Num();
+        const int32 NumFrames = Recorder->GetNumRecordedFrames();
 
         UE_LOG(LogMocapRecorderEditor, Warning,
             TEXT("Session: Target %s stopped. Frames=%d Skeleton=%s"),
@@ -553,23 +733,19 @@ void UMocapCaptureEditorSessionManager::StopSession()
         // Enqueue bake job (manager-level toggle)
         if (bAutoBakeOnStop && NumFrames > 0 && IsValid(Recorder->GetOwner()))
         {
-            UMocapRecorderComponent* Snapshot = Recorder->CreateBakeSnapshot();
-            if (IsValid(Snapshot))
-            {
-                FMocapBakeJob Job;
-                Job.RecorderSnapshot = TStrongObjectPtr<UMocapRecorderComponent>(Snapshot);
+            FMocapBakeJob Job;
+            Job.Recorded = Recorder->TransferRecordedTake();
 
-                Job.AssetName =
-                    !T.OutputNameOverride.IsEmpty()
-                    ? T.OutputNameOverride
-                    : MakeDefaultAssetName(Recorder->GetOwner());
+            Job.AssetName =
+                !T.OutputNameOverride.IsEmpty()
+                ? T.OutputNameOverride
+                : MakeDefaultAssetName(Recorder->GetOwner());
 
-                PendingBakeJobs.Add(MoveTemp(Job));
+            EnqueueBakeJob(MoveTemp(Job));
 
-                UE_LOG(LogMocapRecorderEditor, Warning,
-                    TEXT("StopSession: Added bake job (manual). PendingBakeJobs=%d"),
-                    PendingBakeJobs.Num());
-            }
+            UE_LOG(LogMocapRecorderEditor, Warning,
+                TEXT("StopSession: Added bake job (manual). PendingBakeJobs=%d"),
+                PendingBakeJobs.Num());
         }
 
         // Optional hygiene
@@ -587,6 +763,8 @@ void UMocapCaptureEditorSessionManager::StopSession()
 
     for (FMocapInstanceState& S : ActiveInstances)
     {
+        UnbindFinalizedSampling(S.SkelComp.Get(), S.BoneTransformsFinalizedHandle);
+
         UMocapRecorderComponent* Recorder = S.Recorder.Get();
         if (!IsValid(Recorder))
         {
@@ -598,7 +776,7 @@ void UMocapCaptureEditorSessionManager::StopSession()
             Recorder->StopRecording_External();
         }
 
-        const int32 NumFrames = Recorder->GetRecordedFrames().Num();
+        const int32 NumFrames = Recorder->GetNumRecordedFrames();
 
         UE_LOG(LogMocapRecorderEditor, Warning,
             TEXT("Session: AutoInstance %s stopped. Frames=%d Skeleton=%s"),
@@ -609,23 +787,19 @@ void UMocapCaptureEditorSessionManager::StopSession()
         // Enqueue bake job
         if (bAutoBakeOnStop && NumFrames > 0 && IsValid(Recorder->GetOwner()))
         {
-            UMocapRecorderComponent* Snapshot = Recorder->CreateBakeSnapshot();
-            if (IsValid(Snapshot))
-            {
-                FMocapBakeJob Job;
-                Job.RecorderSnapshot = TStrongObjectPtr<UMocapRecorderComponent>(Snapshot);
+            FMocapBakeJob Job;
+            Job.Recorded = Recorder->TransferRecordedTake();
 
-                Job.AssetName =
-                    !S.OutputNameOverride.IsEmpty()
-                    ? S.OutputNameOverride
-                    : MakeDefaultAssetName(Recorder->GetOwner());
+            Job.AssetName =
+                !S.OutputNameOverride.IsEmpty()
+                ? S.OutputNameOverride
+                : MakeDefaultAssetName(Recorder->GetOwner());
 
-                PendingBakeJobs.Add(MoveTemp(Job));
+            EnqueueBakeJob(MoveTemp(Job));
 
-                UE_LOG(LogMocapRecorderEditor, Warning,
-                    TEXT("StopSession: Added bake job (auto). PendingBakeJobs=%d"),
-                    PendingBakeJobs.Num());
-            }
+            UE_LOG(LogMocapRecorderEditor, Warning,
+                TEXT("StopSession: Added bake job (auto). PendingBakeJobs=%d"),
+                PendingBakeJobs.Num());
         }
 
         // If these recorder components were dynamically created for auto-capture, clean them up.
@@ -635,9 +809,53 @@ void UMocapCaptureEditorSessionManager::StopSession()
     // ------------------------------------------------------------
     // Cleanup auto-capture state AFTER we stopped/enqueued
     // ------------------------------------------------------------
-    ActiveInstances.Reset();
+    ResetActiveInstances();
     PendingAutoCaptureActors.Reset();
+    PendingMeshDeadlines.Reset();
+
+    // Every recorder flushed on StopRecording_External; report backpressure and retire the worker.
+    if (CapturePipeline)
+    {
+        CapturePipeline->Flush();
+
+        const FMocapCapturePipelineStats PipelineStats = CapturePipeline->GetStats();
+        UE_LOG(LogMocapRecorderEditor, Warning,
+            TEXT("Session: CapturePipeline Capacity=%d QueueDepthHighWater=%d Submitted=%lld Committed=%lld Dropped=%lld Stalls=%lld StallMs=%.2f"),
+            PipelineStats.Capacity,
+            PipelineStats.QueueDepthHighWater,
+            PipelineStats.NumSubmitted,
+            PipelineStats.NumCommitted,
+            PipelineStats.NumDropped,
+            PipelineStats.NumStalls,
+            PipelineStats.StallSeconds * 1000.0);
+
+        CapturePipeline.Reset();
+    }
+
+    if (TakeChunkPool)
+    {
+        const FMocapTakeChunkPoolStats PoolStats = TakeChunkPool->GetStats();
+        UE_LOG(LogMocapRecorderEditor, Warning,
+            TEXT("Session: TakeChunkPool LiveMB=%.2f PeakMB=%.2f PooledMB=%.2f HeapChunks=%lld ReusedChunks=%lld"),
+            PoolStats.LiveBytes / (1024.0 * 1024.0),
+            PoolStats.PeakLiveBytes / (1024.0 * 1024.0),
+            PoolStats.PooledBytes / (1024.0 * 1024.0),
+            PoolStats.NumHeapAllocations,
+            PoolStats.NumReuses);
+    }
     SeenAutoCaptureActors.Reset();
+    SweepBacklog.Empty();
+    SweepCursor = 0;
+
+    UE_LOG(LogMocapRecorderEditor, Warning,
+        TEXT("Session: Discovery InitialGatherMs=%.2f InitialCandidates=%d LevelsAdded=%d SweepTotalMs=%.2f SweepMaxMs=%.3f Visited=%lld Queued=%lld"),
+        DiscoveryStats.InitialGatherMs,
+        DiscoveryStats.InitialCandidates,
+        DiscoveryStats.NumLevelsAdded,
+        DiscoveryStats.TotalSweepMs,
+        DiscoveryStats.MaxSweepMs,
+        DiscoveryStats.NumActorsVisited,
+        DiscoveryStats.NumActorsQueued);
 
     UE_LOG(LogMocapRecorderEditor, Warning,
         TEXT("StopSession: DONE PendingBakeJobs=%d"),
@@ -654,7 +872,7 @@ void UMocapCaptureEditorSessionManager::SampleAll()
     if (!bIsRecording)
         return;    
 
-    // Deterministic discovery: if spawn hook misses, we still capture everything.
+    // Discovery: spawns arrive through the hook; pre-existing and streamed-in actors through the sweep backlog.
     SweepWorldForAutoCapture(SweepBudgetPerTick);
     ProcessPendingAutoCaptures(MaxAutoCapturePerTick);
 
@@ -669,7 +887,7 @@ void UMocapCaptureEditorSessionManager::SampleAll()
         UMocapRecorderComponent* Recorder = T.Recorder.Get();
         if (Recorder && Recorder->bIsRecording)
         {
-            Recorder->SampleFrame();
+            SampleRecorder(Recorder);
         }
     }
 
@@ -679,10 +897,13 @@ void UMocapCaptureEditorSessionManager::SampleAll()
         UMocapRecorderComponent* R = S.Recorder.Get();
         if (R && R->bIsRecording)
         {
-            R->SampleFrame();
+            SampleRecorder(R);
         }
     }
 
+    // Every snapshot is converted before auto-stop may stop (and hand off) a recorder.
+    CommitPendingPoses();
+
 
     const float Interval = 1.f / FMath::Max(1.f, CaptureSampleRateHz);
     TickAutoStop(Interval);
@@ -691,6 +912,99 @@ void UMocapCaptureEditorSessionManager::SampleAll()
 
 }
 
+void UMocapCaptureEditorSessionManager::SampleRecorder(UMocapRecorderComponent* Recorder)
+{
+    // Recorders are stamped with the session sample, not their own count, so a missed capture never shifts later frames.
+    if (!bParallelPoseConversion)
+    {
+        Recorder->SampleFrameAtSessionIndex(SessionSampleCounter);
+        return;
+    }
+
+    // Game thread: pose evaluation + component-space copy only.
+    if (Recorder->SampleFrame_Snapshot(SessionSampleCounter))
+    {
+        PendingPoseCommits.Add(Recorder);
+    }
+}
+
+void UMocapCaptureEditorSessionManager::CommitPendingPoses()
+{
+    if (PendingPoseCommits.Num() == 0)
+        return;
+
+    // Each commit writes only its own recorder's take, so recorders convert independently.
+    ParallelFor(PendingPoseCommits.Num(), [this](int32 Index)
+    {
+        PendingPoseCommits[Index]->SampleFrame_CommitSnapshot();
+    });
+
+    PendingPoseCommits.Reset();
+}
+
+// ------------------------------------------------------------
+// BoneTransformsFinalized sampling
+// ------------------------------------------------------------
+
+int64 UMocapCaptureEditorSessionManager::GetSessionSampleIndexNow() const
+{
+    if (!World)
+        return SessionSampleCounter;
+
+    // World time is constant for the whole game frame, so every recorder evaluated
+    // in the same frame lands on the same session sample.
+    const double Elapsed = FMath::Max(0.0, World->GetTimeSeconds() - SessionStartTimeSeconds);
+    return FMath::FloorToInt64(Elapsed * (double)FMath::Max(1.f, CaptureSampleRateHz));
+}
+
+FDelegateHandle UMocapCaptureEditorSessionManager::BindFinalizedSampling(USkeletalMeshComponent* SkelComp, UMocapRecorderComponent* Recorder)
+{
+    if (!IsValid(SkelComp) || !IsValid(Recorder))
+        return FDelegateHandle();
+
+    return SkelComp->RegisterOnBoneTransformsFinalizedDelegate(
+        FOnBoneTransformsFinalizedMultiCast::FDelegate::CreateUObject(
+            this,
+            &UMocapCaptureEditorSessionManager::HandleBoneTransformsFinalized,
+            TWeakObjectPtr<UMocapRecorderComponent>(Recorder)));
+}
+
+void UMocapCaptureEditorSessionManager::UnbindFinalizedSampling(USkeletalMeshComponent* SkelComp, FDelegateHandle& Handle)
+{
+    if (Handle.IsValid() && IsValid(SkelComp))
+    {
+        SkelComp->UnregisterOnBoneTransformsFinalizedDelegate(Handle);
+    }
+    Handle.Reset();
+}
+
+void UMocapCaptureEditorSessionManager::HandleBoneTransformsFinalized(TWeakObjectPtr<UMocapRecorderComponent> WeakRecorder)
+{
+    if (!bIsRecording)
+        return;
+
+    UMocapRecorderComponent* Recorder = WeakRecorder.Get();
+    if (Recorder && Recorder->bIsRecording)
+    {
+        // The mesh just finalized this pose: never re-evaluate from inside its own callback.
+        Recorder->SampleFrameAtSessionIndex(GetSessionSampleIndexNow(), /*bPoseFinalized=*/ true);
+    }
+}
+
+void UMocapCaptureEditorSessionManager::OnWorldPostActorTick(UWorld* InWorld, ELevelTick TickType, float DeltaSeconds)
+{
+    if (!bIsRecording || InWorld != World)
+        return;
+
+    // Poses for this frame were captured during the tick; new instances start at the current sample.
+    SessionSampleCounter = GetSessionSampleIndexNow();
+
+    SweepWorldForAutoCapture(SweepBudgetPerTick);
+    ProcessPendingAutoCaptures(MaxAutoCapturePerTick);
+
+    TickAutoStop(DeltaSeconds);
+}
+
 // ------------------------------------------------------------
 // Spawn hook
 // ------------------------------------------------------------
@@ -704,11 +1018,25 @@ void UMocapCaptureEditorSessionManager::BindSpawnHook()
         FOnActorSpawned::FDelegate::CreateUObject(this, &UMocapCaptureEditorSessionManager::OnActorSpawned)
     );
 
+    LevelAddedHandle = FWorldDelegates::LevelAddedToWorld.AddUObject(this, &UMocapCaptureEditorSessionManager::OnLevelAddedToWorld);
+    LevelRemovedHandle = FWorldDelegates::LevelRemovedFromWorld.AddUObject(this, &UMocapCaptureEditorSessionManager::OnLevelRemovedFromWorld);
+
     UE_LOG(LogMocapRecorderEditor, Warning, TEXT("Resolve: Spawn hook bound (World=%s)."), *GetNameSafe(World));
 }
 
 void UMocapCaptureEditorSessionManager::UnbindSpawnHook()
 {
+    if (LevelAddedHandle.IsValid())
+    {
+        FWorldDelegates::LevelAddedToWorld.Remove(LevelAddedHandle);
+        LevelAddedHandle.Reset();
+    }
+    if (LevelRemovedHandle.IsValid())
+    {
+        FWorldDelegates::LevelRemovedFromWorld.Remove(LevelRemovedHandle);
+        LevelRemovedHandle.Reset();
+    }
+
     if (World && ActorSpawnedHandle.IsValid())
     {
         World->RemoveOnActorSpawnedHandler(ActorSpawnedHandle);
@@ -724,13 +1052,9 @@ void UMocapCaptureEditorSessionManager::OnActorSpawned(AActor* SpawnedActor)
         return;
     }
 
-    // Skeletal-only gate: spawned actor must have a SkeletalMeshComponent with a mesh
-    USkeletalMeshComponent* SkelComp = SpawnedActor->FindComponentByClass<USkeletalMeshComponent>();
-    if (!IsValid(SkelComp) || !IsValid(SkelComp->GetSkeletalMeshAsset()))
+    // Classes no rule can match (most spawns) stop here: one hash lookup, no component search, no logging.
+    if (GetRuleCandidates(SpawnedActor->GetClass()).Num() == 0)
     {
-        UE_LOG(LogMocapRecorderEditor, Warning,
-            TEXT("AutoCapture: Skipping %s (no valid SkeletalMeshComponent/SkeletalMesh)"),
-            *GetNameSafe(SpawnedActor));
         return;
     }
 
@@ -740,45 +1064,28 @@ void UMocapCaptureEditorSessionManager::OnActorSpawned(AActor* SpawnedActor)
         *GetNameSafe(SpawnedActor->GetClass()));
 
     // Match against enabled rules (no TransformOnly path)
-    for (const FMocapClassCaptureRule& Rule : ClassRules)
+    const FMocapClassCaptureRule* Rule = FindMatchingRule(SpawnedActor);
+    if (!Rule || SeenAutoCaptureActors.Contains(SpawnedActor))
     {
-        if (!Rule.bEnabled)
-        {
-            continue;
-        }
-
-        UClass* RuleClass = Rule.ActorClass.Get();
-        if (!RuleClass)
-        {
-            continue;
-        }
-
-        if (!SpawnedActor->IsA(RuleClass))
-        {
-            continue;
-        }
-
-        if (Rule.RequiredTag != NAME_None && !SpawnedActor->ActorHasTag(Rule.RequiredTag))
-        {
-            continue;
-        }
-
-        // If your UI still has this flag, enforce it here (we are skeletal-only anyway)
-        if (Rule.bRequireSkeletalMesh)
-        {
-            // already guaranteed above, but keep explicit for clarity
-        }
+        return;
+    }
 
-        PendingAutoCaptureActors.Add(SpawnedActor);
+    // Queued even without a skeletal mesh yet (assigned after spawn): ProcessPendingAutoCaptures waits a bounded time for it.
+    PendingAutoCaptureActors.Add(SpawnedActor);
+    SeenAutoCaptureActors.Add(SpawnedActor);
 
-        UE_LOG(LogMocapRecorderEditor, Warning,
-            TEXT("AutoCapture: Spawn matched rule class=%s Tag=%s (Pending=%d)"),
-            *GetNameSafe(RuleClass),
-            *Rule.RequiredTag.ToString(),
-            PendingAutoCaptureActors.Num());
+    UE_LOG(LogMocapRecorderEditor, Warning,
+        TEXT("AutoCapture: Spawn matched rule class=%s Tag=%s (Pending=%d)%s"),
+        *GetNameSafe(Rule->ActorClass.Get()),
+        *Rule->RequiredTag.ToString(),
+        PendingAutoCaptureActors.Num(),
+        HasSkeletalMeshToCapture(SpawnedActor) ? TEXT("") : TEXT(" waiting for SkeletalMesh"));
+}
 
-        return;
-    }
+bool UMocapCaptureEditorSessionManager::HasSkeletalMeshToCapture(AActor* Actor)
+{
+    const USkeletalMeshComponent* Skel = FindFirstSkeletalMeshComponent(Actor);
+    return IsValid(Skel) && IsValid(Skel->GetSkeletalMeshAsset());
 }
 
 void UMocapCaptureEditorSessionManager::ProcessPendingAutoCaptures(int32 MaxPerTick)
@@ -787,93 +1094,184 @@ void UMocapCaptureEditorSessionManager::ProcessPendingAutoCaptures(int32 MaxPerT
         return;
 
     int32 Processed = 0;
+    const double NowSeconds = FPlatformTime::Seconds();
 
     for (int32 i = PendingAutoCaptureActors.Num() - 1; i >= 0; --i)
     {
         if (Processed >= MaxPerTick)
             break;
 
-        AActor* Actor = PendingAutoCaptureActors[i].Get();
+        const TWeakObjectPtr<AActor> Pending = PendingAutoCaptureActors[i];
+        AActor* Actor = Pending.Get();
+        if (IsValid(Actor) && !HasSkeletalMeshToCapture(Actor))
+        {
+            // No mesh yet: stays pending until its deadline, so actors that never get one (e.g. static-mesh
+            // projectiles under a broad rule class) do not add to every later tick.
+            const double Deadline = PendingMeshDeadlines.FindOrAdd(Pending, NowSeconds + MocapPendingMeshTimeoutSeconds);
+            if (NowSeconds < Deadline)
+                continue;
+
+            UE_LOG(LogMocapRecorderEditor, Warning,
+                TEXT("AutoCapture: Dropping %s (no SkeletalMesh after %.1f s)"),
+                *GetNameSafe(Actor), MocapPendingMeshTimeoutSeconds);
+            PendingAutoCaptureActors.RemoveAtSwap(i);
+            PendingMeshDeadlines.Remove(Pending);
+            ++Processed;
+            continue;
+        }
+
         PendingAutoCaptureActors.RemoveAtSwap(i);
+        PendingMeshDeadlines.Remove(Pending);
 
         if (!IsValid(Actor))
             continue;
 
-        for (const FMocapClassCaptureRule& Rule : ClassRules)
+        if (const FMocapClassCaptureRule* Rule = FindMatchingRule(Actor))
         {
-            if (!Rule.bEnabled)
-                continue;
+            TryAutoCaptureActor(Actor, *Rule);
+        }
 
-            UClass* RuleClass = Rule.ActorClass.Get();
-            if (!RuleClass)
-                continue;
+        ++Processed;
+    }
+}
 
-            if (!Actor->IsA(RuleClass))
-                continue;
+const FMocapClassCaptureRule* UMocapCaptureEditorSessionManager::FindMatchingRule(AActor* Actor)
+{
+    for (const int32 RuleIndex : GetRuleCandidates(Actor->GetClass()))
+    {
+        const FMocapClassCaptureRule& Rule = ClassRules[RuleIndex];
+        if (Rule.RequiredTag != NAME_None && !Actor->ActorHasTag(Rule.RequiredTag))
+            continue;
 
-            if (Rule.RequiredTag != NAME_None && !Actor->ActorHasTag(Rule.RequiredTag))
-                continue;
+        return &Rule;
+    }
 
-            TryAutoCaptureActor(Actor, Rule);
-            break;
-        }
+    return nullptr;
+}
 
-        ++Processed;
+void UMocapCaptureEditorSessionManager::CompileRuleMatcher()
+{
+    CompiledRuleClasses.Reset();
+    RuleCandidatesByClass.Reset();
+
+    for (int32 RuleIndex = 0; RuleIndex < ClassRules.Num(); ++RuleIndex)
+    {
+        const FMocapClassCaptureRule& Rule = ClassRules[RuleIndex];
+
+        // Non-loading: rules are loaded at session start; an unloaded class cannot have live actors.
+        const UClass* RuleClass = Rule.ActorClass.Get();
+        if (Rule.bEnabled && RuleClass)
+        {
+            CompiledRuleClasses.Emplace(RuleIndex, RuleClass);
+        }
     }
 }
 
-void UMocapCaptureEditorSessionManager::SweepWorldForAutoCapture(int32 MaxToQueueThisTick)
+const UMocapCaptureEditorSessionManager::FMocapRuleCandidates& UMocapCaptureEditorSessionManager::GetRuleCandidates(UClass* ActorClass)
 {
-    if (!bIsRecording)
-        return;
-
-    UWorld* W = nullptr;
+    if (const FMocapRuleCandidates* Cached = RuleCandidatesByClass.Find(ActorClass))
+    {
+        return *Cached;
+    }
 
-#if WITH_EDITOR
-    if (GEditor && GEditor->PlayWorld)
+    // First actor of this class: resolve once, in rule order (the first matching rule wins).
+    FMocapRuleCandidates Candidates;
+    for (const TPair<int32, TWeakObjectPtr<const UClass>>& Compiled : CompiledRuleClasses)
     {
-        W = GEditor->PlayWorld;
+        const UClass* RuleClass = Compiled.Value.Get();
+        if (ActorClass && RuleClass && ActorClass->IsChildOf(RuleClass))
+        {
+            Candidates.Add(Compiled.Key);
+        }
     }
-#endif
 
-    if (!W)
+    return RuleCandidatesByClass.Add(ActorClass, MoveTemp(Candidates));
+}
+
+void UMocapCaptureEditorSessionManager::OnObjectsReplaced(const TMap<UObject*, UObject*>& ReplacementMap)
+{
+    // Blueprint recompile / reinstancing: rule classes resolve to the new class, memoized classes may be stale.
+    for (const TPair<UObject*, UObject*>& Replaced : ReplacementMap)
     {
-        W = GetWorld();
+        if (Cast<UClass>(Replaced.Key) || Cast<UClass>(Replaced.Value))
+        {
+            CompileRuleMatcher();
+            return;
+        }
     }
+}
 
-    if (!IsValid(W))
-        return;
+void UMocapCaptureEditorSessionManager::BeginAutoCaptureDiscovery()
+{
+    SweepBacklog.Reset();
+    SweepCursor = 0;
+    DiscoveryStats = FMocapDiscoveryStats();
 
-    const int32 MaxToQueue = FMath::Max(0, MaxToQueueThisTick);
-    if (MaxToQueue == 0)
+    if (!IsValid(World))
         return;
 
-    // If no enabled rules have a loaded class, don’t sweep.
-    bool bAnyRuleEnabled = false;
-    for (const FMocapClassCaptureRule& Rule : ClassRules)
+    const double StartSeconds = FPlatformTime::Seconds();
+
+    TArray<const UClass*> RuleClasses;
+    for (const TPair<int32, TWeakObjectPtr<const UClass>>& Compiled : CompiledRuleClasses)
+    {
+        if (const UClass* RuleClass = Compiled.Value.Get())
+        {
+            RuleClasses.AddUnique(RuleClass);
+        }
+    }
+
+    // Class-filtered iterators only visit actors of the rule classes, never the whole world.
+    // A class under another rule class is already covered by that class's pass.
+    for (const UClass* RuleClass : RuleClasses)
     {
-        if (!Rule.bEnabled)
+        const bool bCovered = RuleClasses.ContainsByPredicate([RuleClass](const UClass* Other)
+            {
+                return Other != RuleClass && RuleClass->IsChildOf(Other);
+            });
+        if (bCovered)
             continue;
 
-        // ActorClass is TSoftClassPtr<AActor>
-        UClass* RuleClass = Rule.ActorClass.Get(); // non-loading; null if not loaded
-        if (RuleClass != nullptr)
+        for (TActorIterator<AActor> It(World, RuleClass); It; ++It)
         {
-            bAnyRuleEnabled = true;
-            break;
+            SweepBacklog.Add(*It);
         }
     }
-    if (!bAnyRuleEnabled)
+
+    DiscoveryStats.InitialCandidates = SweepBacklog.Num();
+    DiscoveryStats.InitialGatherMs = (FPlatformTime::Seconds() - StartSeconds) * 1000.0;
+    DiscoveryStats.BacklogRemaining = SweepBacklog.Num();
+
+    UE_LOG(LogMocapRecorderEditor, Warning,
+        TEXT("AutoCapture: Discovery gathered %d candidates for %d rule classes in %.2f ms"),
+        DiscoveryStats.InitialCandidates, RuleClasses.Num(), DiscoveryStats.InitialGatherMs);
+}
+
+void UMocapCaptureEditorSessionManager::SweepWorldForAutoCapture(int32 MaxToQueueThisTick)
+{
+    DiscoveryStats.LastSweepMs = 0.0;
+
+    if (!bIsRecording || SweepCursor >= SweepBacklog.Num())
+        return;
+
+    const int32 MaxToQueue = FMath::Max(0, MaxToQueueThisTick);
+    if (MaxToQueue == 0)
         return;
 
+    const double StartSeconds = FPlatformTime::Seconds();
+    const double DeadlineSeconds = StartSeconds + SweepTimeBudgetMs / 1000.0;
+
+    int32 Visited = 0;
     int32 Queued = 0;
 
-    for (TActorIterator<AActor> It(W); It; ++It)
+    while (SweepCursor < SweepBacklog.Num() && Queued < MaxToQueue)
     {
-        if (Queued >= MaxToQueue)
+        if (Visited > 0 && Visited % MocapSweepClockInterval == 0 && FPlatformTime::Seconds() >= DeadlineSeconds)
             break;
 
-        AActor* A = *It;
+        AActor* A = SweepBacklog[SweepCursor++].Get();
+        ++Visited;
+
         if (!IsValid(A))
             continue;
 
@@ -881,31 +1279,67 @@ void UMocapCaptureEditorSessionManager::SweepWorldForAutoCapture(int32 MaxToQueu
         if (SeenAutoCaptureActors.Contains(A))
             continue;
 
-        const FMocapClassCaptureRule* MatchRule = nullptr;
-
-        for (const FMocapClassCaptureRule& Rule : ClassRules)
-        {
-            if (!Rule.bEnabled)
-                continue;
-
-            UClass* RuleClass = Rule.ActorClass.Get(); // non-loading
-            if (RuleClass == nullptr)
-                continue;
-
-            if (A->IsA(RuleClass))
-            {
-                MatchRule = &Rule;
-                break;
-            }
-        }
-
-        if (!MatchRule)
+        if (!FindMatchingRule(A))
             continue;
 
         PendingAutoCaptureActors.Add(A);
         SeenAutoCaptureActors.Add(A);
         ++Queued;
     }
+
+    if (SweepCursor >= SweepBacklog.Num())
+    {
+        SweepBacklog.Reset();
+        SweepCursor = 0;
+    }
+
+    const double ElapsedMs = (FPlatformTime::Seconds() - StartSeconds) * 1000.0;
+    DiscoveryStats.LastSweepMs = ElapsedMs;
+    DiscoveryStats.MaxSweepMs = FMath::Max(DiscoveryStats.MaxSweepMs, ElapsedMs);
+    DiscoveryStats.TotalSweepMs += ElapsedMs;
+    DiscoveryStats.NumActorsVisited += Visited;
+    DiscoveryStats.NumActorsQueued += Queued;
+    DiscoveryStats.BacklogRemaining = SweepBacklog.Num() - SweepCursor;
+
+    UE_LOG(LogMocapRecorderEditor, Verbose,
+        TEXT("AutoCapture: Sweep visited=%d queued=%d backlog=%d in %.3f ms"),
+        Visited, Queued, DiscoveryStats.BacklogRemaining, ElapsedMs);
+}
+
+void UMocapCaptureEditorSessionManager::OnLevelAddedToWorld(ULevel* Level, UWorld* InWorld)
+{
+    if (!bIsRecording || InWorld != World || !Level)
+        return;
+
+    // Filtered when swept: appending is all the work done on the streaming callback.
+    SweepBacklog.Reserve(SweepBacklog.Num() + Level->Actors.Num());
+    for (AActor* A : Level->Actors)
+    {
+        if (A)
+        {
+            SweepBacklog.Add(A);
+        }
+    }
+
+    ++DiscoveryStats.NumLevelsAdded;
+    DiscoveryStats.BacklogRemaining = SweepBacklog.Num() - SweepCursor;
+}
+
+void UMocapCaptureEditorSessionManager::OnLevelRemovedFromWorld(ULevel* Level, UWorld* InWorld)
+{
+    if (!bIsRecording || InWorld != World || SweepCursor >= SweepBacklog.Num())
+        return;
+
+    // Drop the level's unswept actors (a null level means every level is going away).
+    SweepBacklog.RemoveAt(0, SweepCursor);
+    SweepCursor = 0;
+    SweepBacklog.RemoveAllSwap([Level](const TWeakObjectPtr<AActor>& Candidate)
+        {
+            const AActor* A = Candidate.Get();
+            return !A || !Level || A->GetLevel() == Level;
+        });
+
+    DiscoveryStats.BacklogRemaining = SweepBacklog.Num();
 }
 
 bool UMocapCaptureEditorSessionManager::TryAutoCaptureActor(AActor* Actor, const FMocapClassCaptureRule& Rule)
@@ -917,15 +1351,12 @@ bool UMocapCaptureEditorSessionManager::TryAutoCaptureActor(AActor* Actor, const
         return false;
 
     // Avoid duplicates
-    for (const FMocapInstanceState& Existing : ActiveInstances)
-    {
-        if (Existing.Actor.Get() == Actor)
-            return false;
-    }
+    if (FindActiveInstanceIndex(Actor) != INDEX_NONE)
+        return false;
 
-    // Skeletal-only policy: MUST have a SkeletalMeshComponent.
+    // Skeletal-only policy: MUST have a SkeletalMeshComponent with a mesh.
     USkeletalMeshComponent* Skel = FindFirstSkeletalMeshComponent(Actor);
-    if (!Skel)
+    if (!Skel || !IsValid(Skel->GetSkeletalMeshAsset()))
         return false;
 
     UMocapRecorderComponent* Recorder = Actor->FindComponentByClass<UMocapRecorderComponent>();
@@ -949,8 +1380,6 @@ bool UMocapCaptureEditorSessionManager::TryAutoCaptureActor(AActor* Actor, const
     S.Actor = Actor;
     S.SkelComp = Skel;
     S.Recorder = Recorder;
-    S.LastLocation = Actor->GetActorLocation();
-    S.StationarySeconds = 0.f;
     S.bStopRequested = false;
     S.Settings = Rule.AutoStop;
 
@@ -958,7 +1387,18 @@ bool UMocapCaptureEditorSessionManager::TryAutoCaptureActor(AActor* Actor, const
     S.SpawnSampleIndex = SessionSampleCounter;
 
     // Start recording (skeletal-only)
+    if (PoseStorage.IsSet())
+    {
+        Recorder->PoseStorage = PoseStorage.GetValue();
+    }
+    if (TakeCompression.IsSet())
+    {
+        Recorder->TakeCompression = TakeCompression.GetValue();
+    }
+    Recorder->BoneMask = Rule.BoneMask;
+    Recorder->SetTakeChunkPool(TakeChunkPool);
     Recorder->StartRecording_ExternalWithPreRoll(SessionSampleCounter);
+    Recorder->SetCapturePipeline(CapturePipeline);
 
     // Store name now so we still have it even if actor gets destroyed
     S.OutputNameOverride = MakeDefaultAssetName(Actor);
@@ -984,11 +1424,16 @@ bool UMocapCaptureEditorSessionManager::TryAutoCaptureActor(AActor* Actor, const
     }
 
     UE_LOG(LogMocapRecorderEditor, Warning,
-        TEXT("Session: AutoCapture START %s SkeletalOnly SampleStart=%d"),
+        TEXT("Session: AutoCapture START %s SkeletalOnly SampleStart=%lld"),
         *GetNameSafe(Actor),
         SessionSampleCounter);
 
-    ActiveInstances.Add(S);
+    if (SamplingMode == EMocapSessionSamplingMode::BoneTransformsFinalized)
+    {
+        S.BoneTransformsFinalizedHandle = BindFinalizedSampling(Skel, Recorder);
+    }
+
+    AddActiveInstance(MoveTemp(S));
 
     UE_LOG(LogMocapRecorderEditor, Warning,
         TEXT("AutoCapture: Added instance. ActiveInstances=%d Actor=%s"),
@@ -1018,16 +1463,103 @@ void UMocapCaptureEditorSessionManager::RequestStopForActor(AActor* Actor)
     if (!Actor)
         return;
 
-    for (FMocapInstanceState& S : ActiveInstances)
+    const int32 Index = FindActiveInstanceIndex(Actor);
+    if (Index != INDEX_NONE)
     {
-        if (S.Actor.Get() == Actor)
-        {
-            S.bStopRequested = true;
-            return;
-        }
+        ActiveInstances[Index].bStopRequested = true;
+    }
+}
+
+int32 UMocapCaptureEditorSessionManager::FindActiveInstanceIndex(AActor* Actor) const
+{
+    const int32* Index = ActiveInstanceIndexByActor.Find(TObjectKey<AActor>(Actor));
+    return Index ? *Index : INDEX_NONE;
+}
+
+void UMocapCaptureEditorSessionManager::AddActiveInstance(FMocapInstanceState&& State)
+{
+    const AActor* A = State.Actor.Get();
+    State.ActorKey = TObjectKey<AActor>(A);
+    AutoStopLanes.Add(A ? A->GetActorLocation() : FVector::ZeroVector, State.Settings);
+
+    const TObjectKey<AActor> Key = State.ActorKey;
+    const int32 Index = ActiveInstances.Add(MoveTemp(State));
+    ActiveInstanceIndexByActor.Add(Key, Index);
+    check(AutoStopLanes.Num() == ActiveInstances.Num());
+}
+
+void UMocapCaptureEditorSessionManager::RemoveActiveInstanceAtSwap(int32 Index)
+{
+    check(ActiveInstances.IsValidIndex(Index));
+
+    ActiveInstanceIndexByActor.Remove(ActiveInstances[Index].ActorKey);
+    ActiveInstances.RemoveAtSwap(Index);
+    AutoStopLanes.RemoveAtSwap(Index);
+
+    // The last instance moved into the freed slot.
+    if (ActiveInstances.IsValidIndex(Index))
+    {
+        ActiveInstanceIndexByActor.Add(ActiveInstances[Index].ActorKey, Index);
     }
 }
 
+void UMocapCaptureEditorSessionManager::ResetActiveInstances()
+{
+    ActiveInstances.Reset();
+    ActiveInstanceIndexByActor.Reset();
+    AutoStopLanes.Reset();
+}
+
+void FMocapAutoStopLanes::Add(const FVector& Location, const FMocapAutoStopSettings& Settings)
+{
+    LastX.Add(Location.X);
+    LastY.Add(Location.Y);
+    LastZ.Add(Location.Z);
+    CurX.Add(Location.X);
+    CurY.Add(Location.Y);
+    CurZ.Add(Location.Z);
+    StationarySeconds.Add(0.f);
+
+    const bool bStationary = Settings.bStopWhenNearlyStationary;
+    SpeedThresholdSq.Add(bStationary ? FMath::Square((double)FMath::Max(0.f, Settings.LinearSpeedThreshold)) : -1.0);
+    HoldSeconds.Add(bStationary ? FMath::Max(0.f, Settings.StationaryHoldSeconds) : MAX_flt);
+
+    const bool bRadius = Settings.bStopWhenOutOfPlayerRadius && Settings.PlayerRadius > 0.f;
+    RadiusSq.Add(bRadius ? FMath::Square((double)Settings.PlayerRadius) : MAX_dbl);
+
+    StopReason.Add(0);
+}
+
+void FMocapAutoStopLanes::RemoveAtSwap(int32 Index)
+{
+    LastX.RemoveAtSwap(Index);
+    LastY.RemoveAtSwap(Index);
+    LastZ.RemoveAtSwap(Index);
+    CurX.RemoveAtSwap(Index);
+    CurY.RemoveAtSwap(Index);
+    CurZ.RemoveAtSwap(Index);
+    StationarySeconds.RemoveAtSwap(Index);
+    SpeedThresholdSq.RemoveAtSwap(Index);
+    HoldSeconds.RemoveAtSwap(Index);
+    RadiusSq.RemoveAtSwap(Index);
+    StopReason.RemoveAtSwap(Index);
+}
+
+void FMocapAutoStopLanes::Reset()
+{
+    LastX.Reset();
+    LastY.Reset();
+    LastZ.Reset();
+    CurX.Reset();
+    CurY.Reset();
+    CurZ.Reset();
+    StationarySeconds.Reset();
+    SpeedThresholdSq.Reset();
+    HoldSeconds.Reset();
+    RadiusSq.Reset();
+    StopReason.Reset();
+}
+
 void UMocapCaptureEditorSessionManager::HandleAutoCapturedActorDestroyed(AActor* DestroyedActor)
 {
     RequestStopForActor(DestroyedActor);
@@ -1043,16 +1575,68 @@ APawn* UMocapCaptureEditorSessionManager::GetPrimaryPlayerPawn() const
     return (World) ? UGameplayStatics::GetPlayerPawn(World, 0) : nullptr;
 }
 
-bool UMocapCaptureEditorSessionManager::IsOutOfPlayerRadius(AActor* Actor, float Radius) const
+void UMocapCaptureEditorSessionManager::EvaluateAutoStopPolicies(float DeltaTime)
 {
-    if (!Actor || Radius <= 0.f)
-        return false;
+    FMocapAutoStopLanes& L = AutoStopLanes;
+    const int32 Num = L.Num();
+    check(Num == ActiveInstances.Num());
 
-    APawn* Player = GetPrimaryPlayerPawn();
-    if (!Player)
-        return false;
+    if (Num == 0)
+        return;
 
-    return FVector::DistSquared(Actor->GetActorLocation(), Player->GetActorLocation()) > FMath::Square(Radius);
+    // Gather: the only per-instance pointer chase. A dead actor keeps its last position (it is dropped below anyway).
+    for (int32 i = 0; i < Num; ++i)
+    {
+        const AActor* Actor = ActiveInstances[i].Actor.Get();
+        const FVector Location = Actor ? Actor->GetActorLocation() : FVector(L.LastX[i], L.LastY[i], L.LastZ[i]);
+        L.CurX[i] = Location.X;
+        L.CurY[i] = Location.Y;
+        L.CurZ[i] = Location.Z;
+    }
+
+    // No player pawn: the radius policy cannot be judged, so nothing is out of range.
+    const APawn* Player = GetPrimaryPlayerPawn();
+    const FVector PlayerLocation = Player ? Player->GetActorLocation() : FVector::ZeroVector;
+    const double RadiusScale = Player ? 1.0 : 0.0;
+
+    // speed <= threshold  <=>  step^2 <= threshold^2 * dt^2 (no sqrt, no divide).
+    const double DtSq = FMath::Square((double)DeltaTime);
+    const float Dt = FMath::Max(0.f, DeltaTime);
+
+    double* RESTRICT LastX = L.LastX.GetData();
+    double* RESTRICT LastY = L.LastY.GetData();
+    double* RESTRICT LastZ = L.LastZ.GetData();
+    const double* RESTRICT CurX = L.CurX.GetData();
+    const double* RESTRICT CurY = L.CurY.GetData();
+    const double* RESTRICT CurZ = L.CurZ.GetData();
+    float* RESTRICT Stationary = L.StationarySeconds.GetData();
+    const double* RESTRICT SpeedSq = L.SpeedThresholdSq.GetData();
+    const float* RESTRICT Hold = L.HoldSeconds.GetData();
+    const double* RESTRICT RadiusSq = L.RadiusSq.GetData();
+    uint8* RESTRICT StopReason = L.StopReason.GetData();
+
+    for (int32 i = 0; i < Num; ++i)
+    {
+        const double SX = CurX[i] - LastX[i];
+        const double SY = CurY[i] - LastY[i];
+        const double SZ = CurZ[i] - LastZ[i];
+        const double StepSq = SX * SX + SY * SY + SZ * SZ;
+
+        const double PX = CurX[i] - PlayerLocation.X;
+        const double PY = CurY[i] - PlayerLocation.Y;
+        const double PZ = CurZ[i] - PlayerLocation.Z;
+        const double PlayerDistSq = (PX * PX + PY * PY + PZ * PZ) * RadiusScale;
+
+        const bool bStill = StepSq <= SpeedSq[i] * DtSq;
+        Stationary[i] = bStill ? Stationary[i] + Dt : 0.f;
+
+        // Gated on bStill: with a zero hold a moving instance has Stationary == 0 >= Hold and must not stop.
+        StopReason[i] = (uint8)(bStill && Stationary[i] >= Hold[i]) | ((uint8)(PlayerDistSq > RadiusSq[i]) << 1);
+
+        LastX[i] = CurX[i];
+        LastY[i] = CurY[i];
+        LastZ[i] = CurZ[i];
+    }
 }
 
 static bool ExportMeshAssetToFbx_IfMissing(const FString& MeshAssetPath, FString& OutMeshFbxPath)
@@ -1113,7 +1697,7 @@ void UMocapCaptureEditorSessionManager::FinalizeAutoInstanceOutput(const FMocapI
     const int32 NumFrames =
         bTransformOnly
         ? Recorder->GetRecordedTransformFrames().Num()
-        : Recorder->GetRecordedFrames().Num();
+        : Recorder->GetNumRecordedFrames();
 
     UE_LOG(LogMocapRecorderEditor, Warning,
         TEXT("FinalizeAutoInstanceOutput: Actor=%s Frames=%d TransformOnly=%d Skeleton=%s"),
@@ -1130,28 +1714,27 @@ void UMocapCaptureEditorSessionManager::FinalizeAutoInstanceOutput(const FMocapI
     // IMPORTANT: TransformOnly should bake like skeletal (no TransformOnlyBakeSkeleton dependency)
     if (bAutoBakeOnStop)
     {
-        UMocapRecorderComponent* Snapshot = Recorder->CreateBakeSnapshot();
-        if (IsValid(Snapshot))
-        {
-            FMocapBakeJob Job;
-            Job.RecorderSnapshot = TStrongObjectPtr<UMocapRecorderComponent>(Snapshot);
+        FMocapBakeJob Job;
+        Job.Recorded = Recorder->TransferRecordedTake();
 
-            Job.AssetName =
-                !S.OutputNameOverride.IsEmpty()
-                ? S.OutputNameOverride
-                : MakeDefaultAssetName(Recorder->GetOwner());
+        Job.AssetName =
+            !S.OutputNameOverride.IsEmpty()
+            ? S.OutputNameOverride
+            : MakeDefaultAssetName(Recorder->GetOwner());
 
-            PendingBakeJobs.Add(MoveTemp(Job));
+        EnqueueBakeJob(MoveTemp(Job));
 
-            UE_LOG(LogMocapRecorderEditor, Warning,
-                TEXT("FinalizeAutoInstanceOutput: Enqueued BAKE job. PendingBakeJobs=%d"),
-                PendingBakeJobs.Num());
-        }
+        UE_LOG(LogMocapRecorderEditor, Warning,
+            TEXT("FinalizeAutoInstanceOutput: Enqueued BAKE job. PendingBakeJobs=%d"),
+            PendingBakeJobs.Num());
     }
 }
 
 void UMocapCaptureEditorSessionManager::TickAutoStop(float DeltaTime)
 {
+    // 0) Stationary / player-radius policies for every instance in one batch (fills AutoStopLanes.StopReason).
+    EvaluateAutoStopPolicies(DeltaTime);
+
     // 1) Process active instances: stop/remove as needed.
     for (int32 i = ActiveInstances.Num() - 1; i >= 0; --i)
     {
@@ -1163,7 +1746,8 @@ void UMocapCaptureEditorSessionManager::TickAutoStop(float DeltaTime)
         // If recorder is gone, drop instance
         if (!IsValid(R))
         {
-            ActiveInstances.RemoveAtSwap(i);
+            UnbindFinalizedSampling(S.SkelComp.Get(), S.BoneTransformsFinalizedHandle);
+            RemoveActiveInstanceAtSwap(i);
             continue;
         }
 
@@ -1171,7 +1755,8 @@ void UMocapCaptureEditorSessionManager::TickAutoStop(float DeltaTime)
         if (!IsValid(Actor))
         {
             FinalizeAutoInstanceOutput(S, R);
-            ActiveInstances.RemoveAtSwap(i);
+            UnbindFinalizedSampling(S.SkelComp.Get(), S.BoneTransformsFinalizedHandle);
+            RemoveActiveInstanceAtSwap(i);
             continue;
         }
 
@@ -1179,19 +1764,29 @@ void UMocapCaptureEditorSessionManager::TickAutoStop(float DeltaTime)
         if (!R->bIsRecording)
         {
             FinalizeAutoInstanceOutput(S, R);
-            ActiveInstances.RemoveAtSwap(i);
+            UnbindFinalizedSampling(S.SkelComp.Get(), S.BoneTransformsFinalizedHandle);
+            RemoveActiveInstanceAtSwap(i);
             continue;
         }
 
-        const bool bStopNow = S.bStopRequested;
+        const uint8 PolicyStop = AutoStopLanes.StopReason[i];
+        const bool bStopNow = S.bStopRequested || PolicyStop != 0;
         if (bStopNow)
         {
+            if (PolicyStop != 0)
+            {
+                UE_LOG(LogMocapRecorderEditor, Log, TEXT("AutoStop: %s stopped (%s)."),
+                    *GetNameSafe(Actor),
+                    (PolicyStop & 1) ? TEXT("stationary") : TEXT("out of player radius"));
+            }
+
             R->StopRecording_External();
 
             // enqueue bake job (including transform-only)
             FinalizeAutoInstanceOutput(S, R);
 
-            ActiveInstances.RemoveAtSwap(i);
+            UnbindFinalizedSampling(S.SkelComp.Get(), S.BoneTransformsFinalizedHandle);
+            RemoveActiveInstanceAtSwap(i);
         }
     }
 
@@ -1265,8 +1860,8 @@ void UMocapCaptureEditorSessionManager::BeginBakeQueue()
         BakeTickerHandle.Reset();
     }
 
+    // Jobs hold no UObjects and the module keeps this manager alive: nothing needs rooting while baking.
     bIsBaking = true;
-    AddToRoot();
 
 
     if (NextBakeJobIndex < 0 || NextBakeJobIndex >= PendingBakeJobs.Num())
@@ -1305,29 +1900,15 @@ bool UMocapCaptureEditorSessionManager::TickBakeQueue(float DeltaTime)
 
     FMocapBakeJob& Job = PendingBakeJobs[NextBakeJobIndex];
 
-    UMocapRecorderComponent* SnapshotRecorder = Job.RecorderSnapshot.Get();
-    if (!IsValid(SnapshotRecorder))
-    {
-        UE_LOG(LogMocapRecorderEditor, Error,
-            TEXT("BakeQueue: Job idx=%d has invalid snapshot - SKIPPING"),
-            NextBakeJobIndex);
-
-        ++NextBakeJobIndex;
-        return true; // keep ticking to continue queue
-    }
-
-    const bool bTO = SnapshotRecorder->IsTransformOnly();
-    const int32 FrameCount =
-        bTO
-        ? SnapshotRecorder->GetRecordedTransformFrames().Num()
-        : SnapshotRecorder->GetRecordedFrames().Num();
+    const int32 FrameCount = Job.Recorded.GetNumRecordedFrames();
 
     if (FrameCount <= 0)
     {
         UE_LOG(LogMocapRecorderEditor, Error,
-            TEXT("BakeQueue: Job idx=%d snapshot has 0 frames - SKIPPING"),
+            TEXT("BakeQueue: Job idx=%d take has 0 frames - SKIPPING"),
             NextBakeJobIndex);
 
+        ReleaseBakeJob(Job);
         ++NextBakeJobIndex;
         return true;
     }
@@ -1349,21 +1930,23 @@ bool UMocapCaptureEditorSessionManager::TickBakeQueue(float DeltaTime)
         PendingBakeJobs.Num(),
         *AssetPath,
         *Job.AssetName,
-        *GetNameSafe(SnapshotRecorder->GetOwner()),
+        *Job.Recorded.SourceName,
         FrameCount,
-        *GetNameSafe(SnapshotRecorder->GetRecordedSkeleton())
+        *Job.Recorded.Skeleton.ToString()
     );
 
     FMocapRecorderEditorModule& Mod =
         FModuleManager::LoadModuleChecked<FMocapRecorderEditorModule>("MocapRecorderEditor");
 
-    UAnimSequence* Anim = Mod.BakeAnimSequenceFromRecorder(
-        SnapshotRecorder,
+    UAnimSequence* Anim = Mod.BakeAnimSequenceFromTake(
+        Job.Recorded,
         AssetPath,
         Job.AssetName,
         ExportFrameRateFps
     );
 
+    BakedCompressionStats.Accumulate(Job.Recorded.Take.GetCompressionStats());
+
     UE_LOG(LogMocapRecorderEditor, Warning, TEXT("BakeQueue: BakeReturn idx=%d name=%s -> %s"),
         NextBakeJobIndex + 1,
         *Job.AssetName,
@@ -1375,13 +1958,43 @@ bool UMocapCaptureEditorSessionManager::TickBakeQueue(float DeltaTime)
     }
     else
     {
+        // Save now rather than at the end of the queue, so the take can go as soon as its asset is on disk.
+        UEditorLoadingAndSavingUtils::SavePackages({ Anim->GetPackage() }, false);
+
         UE_LOG(LogMocapRecorderEditor, Warning, TEXT("BakeQueue: Bake OK -> %s"), *GetNameSafe(Anim));
     }
 
+    // A job is never retried: its take is released whether or not the bake succeeded.
+    ReleaseBakeJob(Job);
+
+    UE_LOG(LogMocapRecorderEditor, Warning, TEXT("BakeQueue: %d jobs still hold %.2f MB of take data"),
+        PendingBakeJobs.Num() - (NextBakeJobIndex + 1), BakeQueueHeldBytes / (1024.0 * 1024.0));
+
     ++NextBakeJobIndex;
     return true;
 }
 
+void UMocapCaptureEditorSessionManager::EnqueueBakeJob(FMocapBakeJob&& Job)
+{
+    Job.HeldBytes = Job.Recorded.GetAllocatedSize();
+    BakeQueueHeldBytes += Job.HeldBytes;
+    PendingBakeJobs.Add(MoveTemp(Job));
+}
+
+void UMocapCaptureEditorSessionManager::ReleaseBakeJob(FMocapBakeJob& Job)
+{
+    check(BakeQueueHeldBytes >= Job.HeldBytes);
+    BakeQueueHeldBytes -= Job.HeldBytes;
+    Job.HeldBytes = 0;
+    Job.Recorded = FMocapRecordedTake();
+
+    // Between sessions nothing will reuse the pooled chunks: hand them back to the heap so memory really shrinks.
+    if (!bIsRecording && TakeChunkPool)
+    {
+        TakeChunkPool->Trim();
+    }
+}
+
 void UMocapCaptureEditorSessionManager::EndBakeQueue()
 {
     if (BakeTickerHandle.IsValid())
@@ -1391,7 +2004,6 @@ void UMocapCaptureEditorSessionManager::EndBakeQueue()
     }
 
     bIsBaking = false;
-    RemoveFromRoot();
 
 }
 
@@ -1408,10 +2020,17 @@ void UMocapCaptureEditorSessionManager::ClearBakeQueue()
     }
 
     PendingBakeJobs.Reset();
+    BakeQueueHeldBytes = 0;
     NextBakeJobIndex = 0;
     bIsBaking = false;
     bBakeDeferredUntilEndPIE = false;
 
+    // Dropping the jobs returned every take chunk to the pool; between sessions give them back to the heap too.
+    if (!bIsRecording && TakeChunkPool)
+    {
+        TakeChunkPool->Trim();
+    }
+
     UE_LOG(LogMocapRecorderEditor, Warning, TEXT("BakeQueue: ClearBakeQueue -> cleared."));
 }
 
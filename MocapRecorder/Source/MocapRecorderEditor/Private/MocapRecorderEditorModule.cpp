@@ -2,7 +2,7 @@
 #include "SMocapRecorderPanel.h"
 #include "MocapRecorderVersion.h"
 
-#include "MocapRecorderComponent.h"
+#include "MocapRecorderTypes.h"
 
 #include "Misc/CoreDelegates.h"
 
@@ -22,6 +22,7 @@
 
 #include "UObject/Package.h"
 #include "UObject/SavePackage.h"
+#include "Misc/FrameRate.h"
 #include "Misc/PackageName.h"
 #include "AssetToolsModule.h"
 #include "Factories/AnimSequenceFactory.h"
@@ -29,6 +30,7 @@
 #include "Editor.h"
 #include "Components/SkeletalMeshComponent.h"
 #include "Engine/SkeletalMesh.h"
+#include "ReferenceSkeleton.h"
 
 static const TCHAR* GMocapRecorderEditor_VersionFingerprint = TEXT("2026-02-02 Step1-HygieneLock P");
 
@@ -340,43 +342,61 @@ static USkeleton* Mocap_GetOrCreateTransformOnlyRootSkeleton()
     return Skel;
 }
 
-UAnimSequence* FMocapRecorderEditorModule::BakeAnimSequenceFromRecorder(
-    UMocapRecorderComponent* Recorder,
+UAnimSequence* FMocapRecorderEditorModule::BakeAnimSequenceFromTake(
+    FMocapRecordedTake& Recorded,
     const FString& PackagePath,
     const FString& AssetName,
     int32 ExportFPS)
 {
-    if (!IsValid(Recorder))
-        return nullptr;
-
-    USkeleton* Skeleton = Recorder->GetRecordedSkeleton();
+    USkeleton* Skeleton = Recorded.Skeleton.LoadSynchronous();
     if (!IsValid(Skeleton))
     {
         UE_LOG(LogTemp, Error,
             TEXT("Bake FAILED: RecordedSkeleton invalid for %s"),
-            *GetNameSafe(Recorder->GetOwner()));
+            *Recorded.SourceName);
         return nullptr;
     }
 
-    const TArray<FMocapFrame>& Frames = Recorder->GetRecordedFrames();
-    const TArray<FName>& BoneNames = Recorder->GetRecordedBoneNames();
+    // Raw captures carry component-space poses only: derive the locals now (parallel over frames).
+    Recorded.ResolveRawCapture();
+
+    const FMocapTake& Take = Recorded.Take;
+    const TArray<FName>& BoneNames = Recorded.GetBoneNames();
 
-    if (Frames.Num() == 0 || BoneNames.Num() == 0)
+    if (Take.Num() == 0 || BoneNames.Num() == 0)
         return nullptr;
 
-    const int32 SourceFPS = FMath::Max(1, FMath::RoundToInt(Recorder->GetRecordedSampleRate()));
     ExportFPS = FMath::Clamp(ExportFPS, 1, 240);
 
-    // Use time-based stepping (more stable than integer division when rates don’t divide cleanly).
-    const double SrcDt = 1.0 / (double)SourceFPS;
-    const double OutDt = 1.0 / (double)ExportFPS;
+    // The take timeline is integer session samples at an exact rational rate, so output frame times map
+    // to source samples without float drift, however long the take.
+    const FFrameRate SourceRate = Take.GetSampleRate();
+    const FFrameRate OutRate(ExportFPS, 1);
+    const FMocapSampleTimeline& Timeline = Take.GetTimeline();
+    const int64 LastSample = Timeline.GetNumSamples() - 1;
 
-    // Duration based on source frames
-    const double Duration = (Frames.Num() - 1) * SrcDt;
+    // Sequencer frame numbers are int32: a longer timeline cannot be addressed (about 1 year at 60 Hz).
+    if (LastSample > MAX_int32)
+    {
+        UE_LOG(LogTemp, Error,
+            TEXT("Bake FAILED: %s spans %lld samples, more than a frame number can address"),
+            *Recorded.SourceName, LastSample + 1);
+        return nullptr;
+    }
 
     // Number of output frames including both endpoints
-    const int32 OutFrames = FMath::Max(1, (int32)FMath::FloorToInt(Duration / OutDt) + 1);
-
+    const int32 OutFrames = FMath::Max(1,
+        FFrameRate::TransformTime(FFrameTime(FFrameNumber(IntCastChecked<int32>(LastSample))), SourceRate, OutRate).FloorToFrame().Value + 1);
+
+    // Output frame -> stored take frame at the nearest source sample (preroll and skipped samples hold their frame).
+    // The same for every bone, so resolved once.
+    TArray<int32> SourceFrames;
+    SourceFrames.SetNumUninitialized(OutFrames);
+    for (int32 OutIdx = 0; OutIdx < OutFrames; ++OutIdx)
+    {
+        const int64 Sample = FFrameRate::TransformTime(FFrameTime(FFrameNumber(OutIdx)), OutRate, SourceRate).RoundToFrame().Value;
+        SourceFrames[OutIdx] = Timeline.FindFrameAtSample(FMath::Clamp<int64>(Sample, 0, LastSample));
+    }
 
     UAnimSequenceFactory* Factory = NewObject<UAnimSequenceFactory>();
     Factory->TargetSkeleton = Skeleton;
@@ -409,45 +429,110 @@ UAnimSequence* FMocapRecorderEditorModule::BakeAnimSequenceFromRecorder(
 
     Controller.RemoveAllBoneTracks();
 
+    // Sparse preroll: output frames that sample the take's leading hold range all get the single hold pose.
+    int32 HoldOutFrames = 0;
+    while (HoldOutFrames < OutFrames && SourceFrames[HoldOutFrames] == 0)
+    {
+        ++HoldOutFrames;
+    }
+
+    // Reused across bones.
+    TArray<FVector3f> Pos;
+    TArray<FQuat4f> Rot;
+    TArray<FVector3f> Scale;
+    int32 NumSingleKeyTracks = 0;
 
+    // Each full channel is stored contiguously per chunk, so each bone's inner loops below read linear runs.
     for (int32 BoneIdx = 0; BoneIdx < BoneNames.Num(); ++BoneIdx)
     {
         const FName BoneName = BoneNames[BoneIdx];
         Controller.AddBoneTrack(BoneName);
 
-        TArray<FVector3f> Pos;
-        TArray<FQuat4f> Rot;
-        TArray<FVector3f> Scale;
+        const bool bBoneRecorded = BoneIdx < Take.GetNumBones();
+        const bool bConstantT = !bBoneRecorded || Take.IsTranslationConstant(BoneIdx);
+        const bool bConstantR = !bBoneRecorded || Take.IsRotationConstant(BoneIdx);
 
-        Pos.SetNum(OutFrames);
-        Rot.SetNum(OutFrames);
-        Scale.SetNum(OutFrames);
+        // A bone whose translation and rotation never moved is one key. Otherwise all three channels get
+        // OutFrames keys: the data controller rejects key arrays of different lengths (leaving the track
+        // empty), so a constant channel next to a moving one repeats its stored value.
+        const int32 NumKeys = (bConstantT && bConstantR) ? 1 : OutFrames;
+        NumSingleKeyTracks += (NumKeys == 1);
 
-        for (int32 OutIdx = 0; OutIdx < OutFrames; ++OutIdx)
+        Pos.SetNumUninitialized(NumKeys);
+        Rot.SetNumUninitialized(NumKeys);
+        Scale.SetNumUninitialized(NumKeys);
+
+        // Preroll hold range (and constant channels) are filled with the first sample, read once.
+        const FVector3f HoldT = bBoneRecorded ? Take.GetTranslation3f(BoneIdx, 0) : FVector3f::ZeroVector;
+        const FQuat4f HoldQ = bBoneRecorded ? Take.GetRotation4f(BoneIdx, 0) : FQuat4f::Identity;
+        const int32 NumHeldPosKeys = bConstantT ? NumKeys : FMath::Min(HoldOutFrames, NumKeys);
+        const int32 NumHeldRotKeys = bConstantR ? NumKeys : FMath::Min(HoldOutFrames, NumKeys);
+
+        for (int32 OutIdx = 0; OutIdx < NumHeldPosKeys; ++OutIdx)
+        {
+            Pos[OutIdx] = HoldT;
+        }
+        for (int32 OutIdx = 0; OutIdx < NumHeldRotKeys; ++OutIdx)
         {
-            const double TSec = OutIdx * OutDt;
-            const int32 SrcIdx = FMath::Clamp((int32)FMath::RoundToInt(TSec / SrcDt), 0, Frames.Num() - 1);
+            Rot[OutIdx] = HoldQ;
+        }
+        for (int32 OutIdx = 0; OutIdx < NumKeys; ++OutIdx)
+        {
+            Scale[OutIdx] = FVector3f(1, 1, 1);
+        }
 
-            const FMocapFrame& F = Frames[SrcIdx];
+        // Samples are already track precision: keys are copied, not converted (the root re-applies its origin).
+        for (int32 OutIdx = NumHeldPosKeys; OutIdx < NumKeys; ++OutIdx)
+        {
+            Pos[OutIdx] = Take.GetTranslation3f(BoneIdx, SourceFrames[OutIdx]);
+        }
+        for (int32 OutIdx = NumHeldRotKeys; OutIdx < NumKeys; ++OutIdx)
+        {
+            Rot[OutIdx] = Take.GetRotation4f(BoneIdx, SourceFrames[OutIdx]);
+        }
 
-            const FVector T =
-                F.Translations.IsValidIndex(BoneIdx)
-                ? F.Translations[BoneIdx]
-                : FVector::ZeroVector;
+        Controller.SetBoneTrackKeys(BoneName, Pos, Rot, Scale);
+    }
 
-            const FQuat Q =
-                F.Rotations.IsValidIndex(BoneIdx)
-                ? F.Rotations[BoneIdx]
-                : FQuat::Identity;
+    // Bone-masked recordings: bones outside the mask get one key of the recorded mesh's reference pose.
+    int32 NumRefPoseTracks = 0;
+    const FMocapSkeletonTopology* Topo = Recorded.Topology.Get();
+    const USkeletalMesh* RecordedMesh = Recorded.MeshAsset.LoadSynchronous();
+    if (Topo && Topo->IsMasked() && RecordedMesh && RecordedMesh->GetRefSkeleton().GetNum() == Topo->NumSkeletonBones)
+    {
+        const FReferenceSkeleton& RefSkel = RecordedMesh->GetRefSkeleton();
 
-            Pos[OutIdx] = FVector3f(T);
-            Rot[OutIdx] = FQuat4f(Q);
-            Scale[OutIdx] = FVector3f(1, 1, 1);
+        TBitArray<> bSkelBoneRecorded(false, RefSkel.GetNum());
+        for (const int32 SkelIdx : Topo->SkeletonIndices)
+        {
+            bSkelBoneRecorded[SkelIdx] = true;
         }
 
-        Controller.SetBoneTrackKeys(BoneName, Pos, Rot, Scale);
+        Pos.SetNumUninitialized(1);
+        Rot.SetNumUninitialized(1);
+        Scale.SetNumUninitialized(1);
+        for (int32 SkelIdx = 0; SkelIdx < RefSkel.GetNum(); ++SkelIdx)
+        {
+            if (bSkelBoneRecorded[SkelIdx])
+                continue;
+
+            const FTransform& RefPose = RefSkel.GetRefBonePose()[SkelIdx];
+            Pos[0] = FVector3f(RefPose.GetTranslation());
+            Rot[0] = FQuat4f(RefPose.GetRotation());
+            Scale[0] = FVector3f(RefPose.GetScale3D());
+
+            const FName BoneName = RefSkel.GetBoneName(SkelIdx);
+            Controller.AddBoneTrack(BoneName);
+            Controller.SetBoneTrackKeys(BoneName, Pos, Rot, Scale);
+            ++NumRefPoseTracks;
+        }
     }
 
+    const FMocapTakeCompressionStats& CompressionStats = Take.GetCompressionStats();
+    UE_LOG(LogTemp, Log, TEXT("Bake: %d/%d bone tracks single-key (static), %d reference-pose tracks (bone mask), %d/%d take channels constant, %d take chunks encoded (max error %.4f cm, %.4f deg)"),
+        NumSingleKeyTracks, BoneNames.Num(), NumRefPoseTracks, Take.GetNumConstantChannels(), Take.GetNumBones() * 2,
+        CompressionStats.NumEncodedChunks, CompressionStats.MaxTranslationError, CompressionStats.MaxRotationErrorDegrees);
+
     Controller.CloseBracket();
     Anim->MarkPackageDirty();
     FAssetRegistryModule::AssetCreated(Anim);
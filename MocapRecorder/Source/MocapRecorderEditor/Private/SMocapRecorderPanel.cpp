@@ -18,6 +18,79 @@
 #include "Misc/Optional.h"
 
 
+namespace
+{
+    // Bone mask as one line of text: empty or "all" = all bones, "root" = root only,
+    // "include: a, b" (or just "a, b"), "exclude: a, b", "branch: a, b".
+    FText FormatBoneMask(const FMocapBoneMask& Mask)
+    {
+        FString Names;
+        for (const FName& Bone : Mask.Bones)
+        {
+            Names += Names.IsEmpty() ? Bone.ToString() : TEXT(", ") + Bone.ToString();
+        }
+
+        switch (Mask.Mode)
+        {
+        case EMocapBoneMaskMode::RootOnly:    return FText::FromString(TEXT("root"));
+        case EMocapBoneMaskMode::Include:     return FText::FromString(TEXT("include: ") + Names);
+        case EMocapBoneMaskMode::Exclude:     return FText::FromString(TEXT("exclude: ") + Names);
+        case EMocapBoneMaskMode::BranchRoots: return FText::FromString(TEXT("branch: ") + Names);
+        default:                              return FText::GetEmpty();
+        }
+    }
+
+    FMocapBoneMask ParseBoneMask(const FString& InText)
+    {
+        FMocapBoneMask Mask;
+
+        FString Text = InText.TrimStartAndEnd();
+        if (Text.IsEmpty() || Text.Equals(TEXT("all"), ESearchCase::IgnoreCase))
+            return Mask;
+
+        if (Text.Equals(TEXT("root"), ESearchCase::IgnoreCase))
+        {
+            Mask.Mode = EMocapBoneMaskMode::RootOnly;
+            return Mask;
+        }
+
+        Mask.Mode = EMocapBoneMaskMode::Include;
+
+        FString Prefix, Names;
+        if (Text.Split(TEXT(":"), &Prefix, &Names))
+        {
+            Prefix.TrimStartAndEndInline();
+            if (Prefix.Equals(TEXT("exclude"), ESearchCase::IgnoreCase))
+            {
+                Mask.Mode = EMocapBoneMaskMode::Exclude;
+            }
+            else if (Prefix.Equals(TEXT("branch"), ESearchCase::IgnoreCase))
+            {
+                Mask.Mode = EMocapBoneMaskMode::BranchRoots;
+            }
+            Text = Names;
+        }
+
+        TArray<FString> Parts;
+        Text.ParseIntoArray(Parts, TEXT(","), true);
+        for (FString& Part : Parts)
+        {
+            Part.TrimStartAndEndInline();
+            if (!Part.IsEmpty())
+            {
+                Mask.Bones.AddUnique(FName(*Part));
+            }
+        }
+
+        // A list with no usable names records everything rather than just the root.
+        if (Mask.Bones.Num() == 0)
+        {
+            Mask.Mode = EMocapBoneMaskMode::All;
+        }
+        return Mask;
+    }
+}
+
 
 // ------------------------------------------------------------
 // Construct
@@ -163,10 +236,37 @@ void SMocapRecorderPanel::Construct(const FArguments& InArgs)
                             {
                                 Line += TEXT("  |  Waiting for UE async compile...");
                             }
+                            Line += FString::Printf(TEXT("  |  Take memory held: %.1f MB"),
+                                SessionManager->GetBakeQueueHeldBytes() / (1024.0 * 1024.0));
 
                             return FText::FromString(Line);
                         })
                     ]
+
+                    // Achieved compression of the baked takes (only once anything was encoded or rejected)
+                    + SVerticalBox::Slot().AutoHeight().Padding(2)
+                    [
+                        SNew(STextBlock)
+                        .Visibility_Lambda([this]()
+                        {
+                            if (!SessionManager)
+                                return EVisibility::Collapsed;
+
+                            const FMocapTakeCompressionStats& Stats = SessionManager->GetBakedCompressionStats();
+                            return (Stats.NumEncodedChunks + Stats.NumOverBudgetChunks) > 0 ? EVisibility::Visible : EVisibility::Collapsed;
+                        })
+                        .Text_Lambda([this]()
+                        {
+                            if (!SessionManager)
+                                return FText::GetEmpty();
+
+                            const FMocapTakeCompressionStats& Stats = SessionManager->GetBakedCompressionStats();
+                            return FText::FromString(FString::Printf(
+                                TEXT("Compression: %d chunks encoded, %d over budget  |  Max error: %.4f cm, %.4f deg"),
+                                Stats.NumEncodedChunks, Stats.NumOverBudgetChunks,
+                                Stats.MaxTranslationError, Stats.MaxRotationErrorDegrees));
+                        })
+                    ]
                 ]
             ]
 
@@ -256,38 +356,210 @@ SMocapRecorderPanel::~SMocapRecorderPanel()
 TSharedRef<SWidget> SMocapRecorderPanel::BuildSettingsPanel()
 {
     return
-        SNew(SHorizontalBox)
+        SNew(SVerticalBox)
 
-        + SHorizontalBox::Slot().AutoWidth().Padding(2)
+        // Row 1: rates
+        + SVerticalBox::Slot().AutoHeight()
         [
-            SNew(STextBlock).Text(FText::FromString(TEXT("Capture Hz")))
-        ]
-        + SHorizontalBox::Slot().AutoWidth().Padding(2)
-        [
-            SNew(SNumericEntryBox<float>)
-                .MinValue(1.f)
-                .MaxValue(240.f)
-                .Value_Lambda([this]() { return SessionManager->GetCaptureSampleRateHz(); })
-                .OnValueChanged_Lambda([this](float V)
-                    {
-                        SessionManager->SetCaptureSampleRateHz(V);
-                    })
+            SNew(SHorizontalBox)
+
+            + SHorizontalBox::Slot().AutoWidth().Padding(2)
+            [
+                SNew(STextBlock).Text(FText::FromString(TEXT("Capture Hz")))
+            ]
+            + SHorizontalBox::Slot().AutoWidth().Padding(2)
+            [
+                SNew(SNumericEntryBox<float>)
+                    .MinValue(1.f)
+                    .MaxValue(240.f)
+                    .Value_Lambda([this]() { return SessionManager->GetCaptureSampleRateHz(); })
+                    .OnValueChanged_Lambda([this](float V)
+                        {
+                            SessionManager->SetCaptureSampleRateHz(V);
+                        })
+            ]
+
+            + SHorizontalBox::Slot().AutoWidth().Padding(10, 2)
+            [
+                SNew(STextBlock).Text(FText::FromString(TEXT("Export FPS")))
+            ]
+            + SHorizontalBox::Slot().AutoWidth().Padding(2)
+            [
+                SNew(SNumericEntryBox<int32>)
+                    .MinValue(1)
+                    .MaxValue(240)
+                    .Value_Lambda([this]() { return SessionManager->GetExportFrameRateFps(); })
+                    .OnValueChanged_Lambda([this](int32 V)
+                        {
+                            SessionManager->SetExportFrameRateFps(V);
+                        })
+            ]
         ]
 
-    + SHorizontalBox::Slot().AutoWidth().Padding(10, 2)
+        // Row 2: sampling (fixed for the duration of a session)
+        + SVerticalBox::Slot().AutoHeight()
         [
-            SNew(STextBlock).Text(FText::FromString(TEXT("Export FPS")))
+            SNew(SHorizontalBox)
+                .IsEnabled_Lambda([this]() { return !IsRecording(); })
+
+                + SHorizontalBox::Slot().AutoWidth().Padding(2).VAlign(VAlign_Center)
+                [
+                    SNew(SCheckBox)
+                        .ToolTipText(FText::FromString(TEXT("Capture each recorder from its mesh's OnBoneTransformsFinalized instead of the session timer.")))
+                        .IsChecked_Lambda([this]()
+                            {
+                                return SessionManager->GetSamplingMode() == EMocapSessionSamplingMode::BoneTransformsFinalized
+                                    ? ECheckBoxState::Checked : ECheckBoxState::Unchecked;
+                            })
+                        .OnCheckStateChanged_Lambda([this](ECheckBoxState State)
+                            {
+                                SessionManager->SetSamplingMode(State == ECheckBoxState::Checked
+                                    ? EMocapSessionSamplingMode::BoneTransformsFinalized : EMocapSessionSamplingMode::Timer);
+                            })
+                        [
+                            SNew(STextBlock).Text(FText::FromString(TEXT("Sample finalized poses")))
+                        ]
+                ]
+
+                + SHorizontalBox::Slot().AutoWidth().Padding(10, 2).VAlign(VAlign_Center)
+                [
+                    SNew(SCheckBox)
+                        .ToolTipText(FText::FromString(TEXT("Timer sampling: convert snapshotted poses in parallel.")))
+                        .IsChecked_Lambda([this]() { return SessionManager->GetParallelPoseConversion() ? ECheckBoxState::Checked : ECheckBoxState::Unchecked; })
+                        .OnCheckStateChanged_Lambda([this](ECheckBoxState State)
+                            {
+                                SessionManager->SetParallelPoseConversion(State == ECheckBoxState::Checked);
+                            })
+                        [
+                            SNew(STextBlock).Text(FText::FromString(TEXT("Parallel conversion")))
+                        ]
+                ]
+
+                + SHorizontalBox::Slot().AutoWidth().Padding(10, 2).VAlign(VAlign_Center)
+                [
+                    SNew(SCheckBox)
+                        .ToolTipText(FText::FromString(TEXT("Timer sampling: convert and append poses on a capture worker thread.")))
+                        .IsChecked_Lambda([this]() { return SessionManager->GetAsyncCapturePipeline() ? ECheckBoxState::Checked : ECheckBoxState::Unchecked; })
+                        .OnCheckStateChanged_Lambda([this](ECheckBoxState State)
+                            {
+                                SessionManager->SetAsyncCapturePipeline(State == ECheckBoxState::Checked);
+                            })
+                        [
+                            SNew(STextBlock).Text(FText::FromString(TEXT("Async pipeline")))
+                        ]
+                ]
         ]
-        + SHorizontalBox::Slot().AutoWidth().Padding(2)
+
+        // Row 3: storage overrides. Unchecked "Override" keeps each recorder's own component settings.
+        + SVerticalBox::Slot().AutoHeight()
         [
-            SNew(SNumericEntryBox<int32>)
-                .MinValue(1)
-                .MaxValue(240)
-                .Value_Lambda([this]() { return SessionManager->GetExportFrameRateFps(); })
-                .OnValueChanged_Lambda([this](int32 V)
-                    {
-                        SessionManager->SetExportFrameRateFps(V);
-                    })
+            SNew(SHorizontalBox)
+                .IsEnabled_Lambda([this]() { return !IsRecording(); })
+
+                + SHorizontalBox::Slot().AutoWidth().Padding(2).VAlign(VAlign_Center)
+                [
+                    SNew(SCheckBox)
+                        .ToolTipText(FText::FromString(TEXT("Override every recorder's pose storage for this session.")))
+                        .IsChecked_Lambda([this]() { return SessionManager->GetPoseStorage().IsSet() ? ECheckBoxState::Checked : ECheckBoxState::Unchecked; })
+                        .OnCheckStateChanged_Lambda([this](ECheckBoxState State)
+                            {
+                                SessionManager->SetPoseStorage(State == ECheckBoxState::Checked
+                                    ? TOptional<EMocapPoseStorage>(EMocapPoseStorage::Derived) : TOptional<EMocapPoseStorage>());
+                            })
+                        [
+                            SNew(STextBlock).Text(FText::FromString(TEXT("Override storage:")))
+                        ]
+                ]
+
+                + SHorizontalBox::Slot().AutoWidth().Padding(2).VAlign(VAlign_Center)
+                [
+                    SNew(SCheckBox)
+                        .IsEnabled_Lambda([this]() { return SessionManager->GetPoseStorage().IsSet(); })
+                        .IsChecked_Lambda([this]()
+                            {
+                                return SessionManager->GetPoseStorage().Get(EMocapPoseStorage::Derived) == EMocapPoseStorage::RawComponentSpace
+                                    ? ECheckBoxState::Checked : ECheckBoxState::Unchecked;
+                            })
+                        .OnCheckStateChanged_Lambda([this](ECheckBoxState State)
+                            {
+                                SessionManager->SetPoseStorage(State == ECheckBoxState::Checked
+                                    ? EMocapPoseStorage::RawComponentSpace : EMocapPoseStorage::Derived);
+                            })
+                        [
+                            SNew(STextBlock).Text(FText::FromString(TEXT("Raw poses")))
+                        ]
+                ]
+
+                + SHorizontalBox::Slot().AutoWidth().Padding(10, 2).VAlign(VAlign_Center)
+                [
+                    SNew(SCheckBox)
+                        .ToolTipText(FText::FromString(TEXT("Override every recorder's take compression for this session.")))
+                        .IsChecked_Lambda([this]() { return SessionManager->GetTakeCompression().IsSet() ? ECheckBoxState::Checked : ECheckBoxState::Unchecked; })
+                        .OnCheckStateChanged_Lambda([this](ECheckBoxState State)
+                            {
+                                SessionManager->SetTakeCompression(State == ECheckBoxState::Checked
+                                    ? TOptional<FMocapTakeCompression>(FMocapTakeCompression()) : TOptional<FMocapTakeCompression>());
+                            })
+                        [
+                            SNew(STextBlock).Text(FText::FromString(TEXT("Override compression:")))
+                        ]
+                ]
+
+                + SHorizontalBox::Slot().AutoWidth().Padding(2).VAlign(VAlign_Center)
+                [
+                    SNew(SCheckBox)
+                        .IsEnabled_Lambda([this]() { return SessionManager->GetTakeCompression().IsSet(); })
+                        .IsChecked_Lambda([this]()
+                            {
+                                const TOptional<FMocapTakeCompression>& Compression = SessionManager->GetTakeCompression();
+                                return Compression.IsSet() && Compression->bEnabled ? ECheckBoxState::Checked : ECheckBoxState::Unchecked;
+                            })
+                        .OnCheckStateChanged_Lambda([this](ECheckBoxState State)
+                            {
+                                FMocapTakeCompression Compression = SessionManager->GetTakeCompression().Get(FMocapTakeCompression());
+                                Compression.bEnabled = State == ECheckBoxState::Checked;
+                                SessionManager->SetTakeCompression(Compression);
+                            })
+                        [
+                            SNew(STextBlock).Text(FText::FromString(TEXT("Compress")))
+                        ]
+                ]
+
+                + SHorizontalBox::Slot().AutoWidth().Padding(10, 2).VAlign(VAlign_Center)
+                [
+                    SNew(STextBlock).Text(FText::FromString(TEXT("Max error cm")))
+                ]
+                + SHorizontalBox::Slot().AutoWidth().Padding(2)
+                [
+                    SNew(SNumericEntryBox<float>)
+                        .MinValue(0.f)
+                        .IsEnabled_Lambda([this]() { return SessionManager->GetTakeCompression().IsSet(); })
+                        .Value_Lambda([this]() { return SessionManager->GetTakeCompression().Get(FMocapTakeCompression()).TranslationErrorBudget; })
+                        .OnValueChanged_Lambda([this](float V)
+                            {
+                                FMocapTakeCompression Compression = SessionManager->GetTakeCompression().Get(FMocapTakeCompression());
+                                Compression.TranslationErrorBudget = FMath::Max(0.f, V);
+                                SessionManager->SetTakeCompression(Compression);
+                            })
+                ]
+
+                + SHorizontalBox::Slot().AutoWidth().Padding(10, 2).VAlign(VAlign_Center)
+                [
+                    SNew(STextBlock).Text(FText::FromString(TEXT("Max error deg")))
+                ]
+                + SHorizontalBox::Slot().AutoWidth().Padding(2)
+                [
+                    SNew(SNumericEntryBox<float>)
+                        .MinValue(0.f)
+                        .IsEnabled_Lambda([this]() { return SessionManager->GetTakeCompression().IsSet(); })
+                        .Value_Lambda([this]() { return SessionManager->GetTakeCompression().Get(FMocapTakeCompression()).RotationErrorBudgetDegrees; })
+                        .OnValueChanged_Lambda([this](float V)
+                            {
+                                FMocapTakeCompression Compression = SessionManager->GetTakeCompression().Get(FMocapTakeCompression());
+                                Compression.RotationErrorBudgetDegrees = FMath::Max(0.f, V);
+                                SessionManager->SetTakeCompression(Compression);
+                            })
+                ]
         ];
 }
 
@@ -417,6 +689,32 @@ TSharedRef<SWidget> SMocapRecorderPanel::BuildClassRulesPanel()
                                                                 SessionManager->SetClassRuleRequiredTag(Index, S.IsEmpty() ? NAME_None : FName(*S));
                                                             }
                                                         })
+                                            ]
+
+                                        + SHorizontalBox::Slot().AutoWidth().Padding(6, 2).VAlign(VAlign_Center)
+                                            [
+                                                SNew(STextBlock).Text(FText::FromString(TEXT("Bones")))
+                                            ]
+
+                                            + SHorizontalBox::Slot().AutoWidth().Padding(2)
+                                            [
+                                                SNew(SEditableTextBox)
+                                                    .MinDesiredWidth(180.f)
+                                                    .HintText(FText::FromString(TEXT("all | root | include/exclude/branch: a, b")))
+                                                    .Text_Lambda([this, Index]()
+                                                        {
+                                                            if (!SessionManager || Index == INDEX_NONE) return FText::GetEmpty();
+                                                            const auto& Rules = SessionManager->GetClassRules();
+                                                            if (!Rules.IsValidIndex(Index)) return FText::GetEmpty();
+                                                            return FormatBoneMask(Rules[Index].BoneMask);
+                                                        })
+                                                    .OnTextCommitted_Lambda([this, Index](const FText& NewText, ETextCommit::Type)
+                                                        {
+                                                            if (SessionManager && Index != INDEX_NONE)
+                                                            {
+                                                                SessionManager->SetRule_BoneMask(Index, ParseBoneMask(NewText.ToString()));
+                                                            }
+                                                        })
                                             ]                                       
 
 
@@ -715,6 +1013,28 @@ TSharedRef<SWidget> SMocapRecorderPanel::BuildTargetList()
 
                                                 })
                                     ]
+
+                                + SHorizontalBox::Slot().AutoWidth().Padding(2)
+                                    [
+                                        SNew(SEditableTextBox)
+                                            .MinDesiredWidth(180.f)
+                                            .HintText(FText::FromString(TEXT("Bones: all")))
+                                            .Text_Lambda([this, Index]()
+                                                {
+                                                    if (!SessionManager || Index == INDEX_NONE)
+                                                        return FText::GetEmpty();
+
+                                                    const TArray<FMocapEditorSessionTarget>& Targets = SessionManager->GetTargets();
+                                                    return Targets.IsValidIndex(Index) ? FormatBoneMask(Targets[Index].BoneMask) : FText::GetEmpty();
+                                                })
+                                            .OnTextCommitted_Lambda([this, Index](const FText& NewText, ETextCommit::Type)
+                                                {
+                                                    if (SessionManager && Index != INDEX_NONE)
+                                                    {
+                                                        SessionManager->SetTargetBoneMask(Index, ParseBoneMask(NewText.ToString()));
+                                                    }
+                                                })
+                                    ]
                             ];
                     })
 
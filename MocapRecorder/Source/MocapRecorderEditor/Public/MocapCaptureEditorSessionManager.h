@@ -1,7 +1,11 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Engine/EngineBaseTypes.h"
+#include "Misc/Optional.h"
 #include "MocapCaptureMode.h"
+#include "MocapRecorderTypes.h"
+#include "UObject/ObjectKey.h"
 
 #include "MocapCaptureEditorSessionManager.generated.h"
 
@@ -12,10 +16,24 @@ class UMocapRecorderComponent;
 class USkeletalMeshComponent;
 class USkeleton;
 class UAnimSequence;
+class FMocapCapturePipeline;
+class FMocapTakeChunkPool;
 
 struct FHitResult;
 
 
+// How a session decides when to capture each recorder.
+UENUM()
+enum class EMocapSessionSamplingMode : uint8
+{
+    // World timer at 1/CaptureSampleRateHz drives SampleAll (legacy). May fire several times per game frame.
+    Timer,
+
+    // Each recorder captures from its mesh's OnBoneTransformsFinalized: exactly one capture per evaluated pose.
+    BoneTransformsFinalized
+};
+
+
 /**
  * Editor-only target record used by Slate/UI.
  * Not a USTRUCT intentionally: avoids global UHT name collisions and keeps UI data lightweight.
@@ -31,7 +49,13 @@ struct FMocapEditorSessionTarget
     bool bEnabled = true;
     FString OutputNameOverride;
 
+    // Bones to record for this target (default: all).
+    FMocapBoneMask BoneMask;
+
     TWeakObjectPtr<UMocapRecorderComponent> Recorder;
+
+    // BoneTransformsFinalized sampling registration on SkelComp (session-owned).
+    FDelegateHandle BoneTransformsFinalizedHandle;
 };
 
 // ============================================================
@@ -44,8 +68,9 @@ struct FMocapAutoStopSettings
 {
     GENERATED_BODY()
 
+    // Root motion only: an in-place animation (idle, talk) counts as stationary. Opt in for props and projectiles.
     UPROPERTY(EditAnywhere)
-    bool bStopWhenNearlyStationary = true;
+    bool bStopWhenNearlyStationary = false;
 
     UPROPERTY(EditAnywhere)
     float LinearSpeedThreshold = 5.f;
@@ -94,22 +119,29 @@ struct FMocapClassCaptureRule
 
     UPROPERTY(EditAnywhere)
     FMocapAutoStopSettings AutoStop;
+
+    // Bones to record for every matching instance (e.g. RootOnly for props, no fingers for crowds).
+    UPROPERTY(EditAnywhere)
+    FMocapBoneMask BoneMask;
 };
 
 
 struct FMocapInstanceState
 {
     TWeakObjectPtr<AActor> Actor;
+    // Identity of Actor taken while it was alive; still unique after the weak pointer goes stale.
+    TObjectKey<AActor> ActorKey;
     TWeakObjectPtr<USkeletalMeshComponent> SkelComp;
     TWeakObjectPtr<UMocapRecorderComponent> Recorder;
-    FVector LastLocation = FVector::ZeroVector;
-    float StationarySeconds = 0.f;
     bool bStopRequested = false;
     // Session frame index when this actor was spawned/capture-started
-    int32 SpawnSampleIndex = 0;
+    int64 SpawnSampleIndex = 0;
     bool bTransformOnly = false;
     // transform-only (no skeleton)
     EMocapCaptureMode CaptureMode = EMocapCaptureMode::Skeletal;
+
+    // BoneTransformsFinalized sampling registration on SkelComp (session-owned).
+    FDelegateHandle BoneTransformsFinalizedHandle;
     FMocapAutoStopSettings Settings;
     FString OutputNameOverride;
 
@@ -120,6 +152,53 @@ struct FMocapInstanceState
     FString SourceMeshAssetPath;
 };
 
+/**
+ * Stationary / player-radius auto-stop state of the active instances, structure-of-arrays: lane i belongs to
+ * ActiveInstances[i] and moves with it. Policies are stored pre-squared, and a disabled policy holds a value its
+ * test can never pass, so one loop tests speed and distance for every instance without per-instance branches.
+ */
+struct FMocapAutoStopLanes
+{
+    // World position at the previous evaluation and at this one, per axis.
+    TArray<double> LastX, LastY, LastZ;
+    TArray<double> CurX, CurY, CurZ;
+
+    TArray<float> StationarySeconds;
+
+    // LinearSpeedThreshold^2 (-1 when disabled), StationaryHoldSeconds (MAX_flt when disabled),
+    // PlayerRadius^2 (MAX_dbl when disabled or non-positive).
+    TArray<double> SpeedThresholdSq;
+    TArray<float> HoldSeconds;
+    TArray<double> RadiusSq;
+
+    // Batch output: 1 = stationary for the hold time, 2 = out of the player radius.
+    TArray<uint8> StopReason;
+
+    int32 Num() const { return StationarySeconds.Num(); }
+    void Add(const FVector& Location, const FMocapAutoStopSettings& Settings);
+    void RemoveAtSwap(int32 Index);
+    void Reset();
+};
+
+/** Auto-capture discovery cost for the current session (the time-sliced world sweep; spawn hook matching is not timed). */
+struct FMocapDiscoveryStats
+{
+    // Class-filtered gather at session start
+    double InitialGatherMs = 0.0;
+    int32 InitialCandidates = 0;
+
+    // Per-tick sweep of the candidate backlog
+    double LastSweepMs = 0.0;
+    double MaxSweepMs = 0.0;
+    double TotalSweepMs = 0.0;
+    int64 NumActorsVisited = 0;
+    int64 NumActorsQueued = 0;
+    int32 BacklogRemaining = 0;
+
+    // Streamed-in levels whose actors were added to the backlog
+    int32 NumLevelsAdded = 0;
+};
+
 
 
 UCLASS()
@@ -138,6 +217,7 @@ public:
     void ClearTargets();
     const TArray<FMocapEditorSessionTarget>& GetTargets() const { return Targets; }
     void SetTargetEnabled(int32 Index, bool bEnabled);
+    void SetTargetBoneMask(int32 Index, const FMocapBoneMask& InMask);
 
     // ------------------------------------------------------------
     // Class Rules (spawned instances)
@@ -166,6 +246,8 @@ public:
 
     void SetRule_AutoBakeOnAutoStop(int32 Index, bool bIn);
 
+    void SetRule_BoneMask(int32 Index, const FMocapBoneMask& InMask);
+
     // ------------------------------------------------------------
     // Session settings
     // ------------------------------------------------------------
@@ -173,11 +255,22 @@ public:
     void SetExportFrameRateFps(int32 InFps) { ExportFrameRateFps = FMath::Clamp(InFps, 1, 240); }
     void SetAssetPath(const FString& InPath) { AssetPath = InPath; }
     void SetAutoBakeOnStop(bool bIn) { bAutoBakeOnStop = bIn; }
+    void SetSamplingMode(EMocapSessionSamplingMode InMode) { if (!bIsRecording) { SamplingMode = InMode; } }
+    void SetParallelPoseConversion(bool bIn) { bParallelPoseConversion = bIn; }
+    void SetAsyncCapturePipeline(bool bIn) { if (!bIsRecording) { bAsyncCapturePipeline = bIn; } }
+    // Unset (the default) leaves each recorder's own PoseStorage / TakeCompression as configured on the component.
+    void SetPoseStorage(TOptional<EMocapPoseStorage> InStorage) { if (!bIsRecording) { PoseStorage = InStorage; } }
+    void SetTakeCompression(TOptional<FMocapTakeCompression> InCompression) { if (!bIsRecording) { TakeCompression = InCompression; } }
 
     float GetCaptureSampleRateHz() const { return CaptureSampleRateHz; }
     int32 GetExportFrameRateFps() const { return ExportFrameRateFps; }
     const FString& GetAssetPath() const { return AssetPath; }
     bool GetAutoBakeOnStop() const { return bAutoBakeOnStop; }
+    EMocapSessionSamplingMode GetSamplingMode() const { return SamplingMode; }
+    bool GetParallelPoseConversion() const { return bParallelPoseConversion; }
+    bool GetAsyncCapturePipeline() const { return bAsyncCapturePipeline; }
+    const TOptional<EMocapPoseStorage>& GetPoseStorage() const { return PoseStorage; }
+    const TOptional<FMocapTakeCompression>& GetTakeCompression() const { return TakeCompression; }
 
     // ------------------------------------------------------------
     // Control
@@ -189,8 +282,16 @@ public:
     bool IsRecording() const { return bIsRecording; }
     bool IsBaking() const { return bIsBaking; }
 
+    const FMocapDiscoveryStats& GetDiscoveryStats() const { return DiscoveryStats; }
+
     void GetBakeQueueStatus(int32& OutDone, int32& OutTotal, FString& OutCurrentAssetName, bool& bOutWaitingForCompilation) const;
 
+    // Take memory still held by bake jobs that have not been baked yet. Shrinks as the queue drains.
+    uint64 GetBakeQueueHeldBytes() const { return BakeQueueHeldBytes; }
+
+    // Take compression achieved by the takes baked since the last StartSession (raw takes encode at bake time).
+    const FMocapTakeCompressionStats& GetBakedCompressionStats() const { return BakedCompressionStats; }
+
     // Clears pending bake jobs and stops any active bake ticker.
     // Use between recording sessions to prevent old jobs baking on later PIE closes.
     UFUNCTION()
@@ -210,9 +311,12 @@ private:
     // One deferred bake task (processed incrementally to avoid editor freeze)
     struct FMocapBakeJob
     {
-        // Snapshot that survives PIE teardown
-        TStrongObjectPtr<UMocapRecorderComponent> RecorderSnapshot;
+        // Take moved out of the recorder; plain data, so it survives PIE teardown without GC cost
+        FMocapRecordedTake Recorded;
         FString AssetName;
+
+        // Recorded.GetAllocatedSize() when queued (what BakeQueueHeldBytes counts for this job)
+        uint64 HeldBytes = 0;
     };
 
 
@@ -230,16 +334,32 @@ private:
 
     TArray<FMocapInstanceState> ActiveInstances;
 
+    // Actor -> slot in ActiveInstances, kept in step by AddActiveInstance / RemoveActiveInstanceAtSwap.
+    // Keyed by object identity, not TWeakObjectPtr: stale weak pointers all compare equal, so a dead actor's
+    // removal could hit another dead actor's entry.
+    TMap<TObjectKey<AActor>, int32> ActiveInstanceIndexByActor;
+
+    // Auto-stop lanes, kept in step with ActiveInstances by the same helpers.
+    FMocapAutoStopLanes AutoStopLanes;
+
+    int32 FindActiveInstanceIndex(AActor* Actor) const;
+    void AddActiveInstance(FMocapInstanceState&& State);
+    void RemoveActiveInstanceAtSwap(int32 Index);
+    void ResetActiveInstances();
+
     // Spawn hook
     FDelegateHandle ActorSpawnedHandle;
 
     // Spawn queue (do not attach components inside spawn callback)
     TArray<TWeakObjectPtr<AActor>> PendingAutoCaptureActors;
 
+    // Pending actors still waiting for a skeletal mesh: platform time after which they are dropped.
+    TMap<TWeakObjectPtr<AActor>, double> PendingMeshDeadlines;
+
     // Limits (avoid runaway bullets)
 
-    // Session timeline sample counter (increments once per SampleAll tick)
-    int32 SessionSampleCounter = 0;
+    // Session timeline sample counter (increments once per SampleAll tick). Every take is timed in these samples.
+    int64 SessionSampleCounter = 0;
 
     int32 MaxAutoCapturePerTick = 512;
     int32 MaxActiveAutoInstances = 2048;
@@ -249,26 +369,97 @@ private:
     int32 ExportFrameRateFps = 30;
     FString AssetPath = TEXT("/Game/MocapCaptures");
     bool bAutoBakeOnStop = true;
+    EMocapSessionSamplingMode SamplingMode = EMocapSessionSamplingMode::Timer;
+
+    // Timer mode: snapshot poses on the game thread, convert them with ParallelFor (same frames as serial).
+    bool bParallelPoseConversion = false;
+
+    // Recorders snapshotted this SampleAll, awaiting their parallel commit (reused to avoid per-tick allocs).
+    TArray<UMocapRecorderComponent*> PendingPoseCommits;
+
+    // Timer mode: game thread only copies poses; a pipeline worker converts and appends them (takes precedence
+    // over bParallelPoseConversion). Created per session.
+    bool bAsyncCapturePipeline = false;
+    int32 CapturePipelineCapacity = 1024;
+    TSharedPtr<FMocapCapturePipeline> CapturePipeline;
+
+    // Fixed-size take chunks for every recorder the session starts. Kept across sessions so the next one
+    // reuses the previous session's memory instead of growing takes from the heap.
+    TSharedPtr<FMocapTakeChunkPool> TakeChunkPool;
+
+    // When set, applied to every recorder the session starts. RawComponentSpace defers all local-space math to the bake.
+    TOptional<EMocapPoseStorage> PoseStorage;
+
+    // When set, applied to every recorder the session starts. Trades bounded error for take memory on very large sessions.
+    TOptional<FMocapTakeCompression> TakeCompression;
 
     bool bIsRecording = false;
     FTimerHandle SessionTimerHandle;
 
+    // BoneTransformsFinalized mode: session clock + per-frame housekeeping hook
+    double SessionStartTimeSeconds = 0.0;
+    FDelegateHandle WorldPostActorTickHandle;
+
     // Bake queue
     TArray<FMocapBakeJob> PendingBakeJobs;
     int32 NextBakeJobIndex = 0;
     bool bIsBaking = false;
     FTSTicker::FDelegateHandle BakeTickerHandle;
+
+    // Sum of HeldBytes over jobs whose take has not been released yet
+    uint64 BakeQueueHeldBytes = 0;
+    FMocapTakeCompressionStats BakedCompressionStats;
+
+    void EnqueueBakeJob(FMocapBakeJob&& Job);
+
+    // Frees a processed job's take (its chunks go back to the pool, which is trimmed between sessions).
+    void ReleaseBakeJob(FMocapBakeJob& Job);
        
 private:
 
+    // Session start: one class-filtered pass per rule class fills the sweep backlog.
+    void BeginAutoCaptureDiscovery();
+
+    // Matches the backlog from the cursor until MaxToQueueThisTick actors are queued or SweepTimeBudgetMs is spent.
     void SweepWorldForAutoCapture(int32 MaxToQueueThisTick);
 
+    // First enabled rule the actor matches (class and tag), or null.
+    const FMocapClassCaptureRule* FindMatchingRule(AActor* Actor);
+
+    // Rule matcher: enabled rules with a loaded class (rule index + class), rebuilt at StartSession and on rule
+    // edits. Per actor class it memoizes the indices of the rules whose class it derives from, so a class no
+    // rule can match is rejected with one hash lookup. Required tags are per actor and checked on top.
+    // Classes are held weakly (not GC-tracked here) and recompiled when a Blueprint recompile reinstances objects.
+    using FMocapRuleCandidates = TArray<int32, TInlineAllocator<2>>;
+    TArray<TPair<int32, TWeakObjectPtr<const UClass>>> CompiledRuleClasses;
+    TMap<TObjectKey<UClass>, FMocapRuleCandidates> RuleCandidatesByClass;
+
+    void CompileRuleMatcher();
+    const FMocapRuleCandidates& GetRuleCandidates(UClass* ActorClass);
+    void OnObjectsReplaced(const TMap<UObject*, UObject*>& ReplacementMap);
+
+    FDelegateHandle ObjectsReplacedHandle;
+
+    // Level streaming: streamed-in actors never reach the spawn hook, so their level is swept instead.
+    void OnLevelAddedToWorld(ULevel* Level, UWorld* InWorld);
+    void OnLevelRemovedFromWorld(ULevel* Level, UWorld* InWorld);
+
 
     // Actors we've already decided to capture (active OR pending), to avoid duplicates.
     TSet<TWeakObjectPtr<AActor>> SeenAutoCaptureActors;
 
-    // Optional: if you want to sweep every tick but with a budget
+    // Candidates not yet matched against the rules; SweepCursor is the next one. Reset once fully swept.
+    TArray<TWeakObjectPtr<AActor>> SweepBacklog;
+    int32 SweepCursor = 0;
+
+    // Per-tick sweep limits: actors queued, and wall time
     int32 SweepBudgetPerTick = 512;
+    double SweepTimeBudgetMs = 0.5;
+
+    FMocapDiscoveryStats DiscoveryStats;
+
+    FDelegateHandle LevelAddedHandle;
+    FDelegateHandle LevelRemovedHandle;
 
 
     // Post-PIE bake kick (EndPIE can fire before PlayWorld is nulled)
@@ -281,7 +472,23 @@ private:
     // Core helpers
     bool ResolveOrAttachRecorder(FMocapEditorSessionTarget& T);
     void ResolveTargetsForWorld(UWorld* InWorld);
-    static AActor* FindActorByGuid(UWorld* InWorld, const FGuid& Guid);
+    AActor* FindActorByGuid(UWorld* InWorld, const FGuid& Guid);
+
+    // GUID -> actor index for target resolution: built in one world pass on first lookup, dropped when an
+    // actor or level is added to or removed from that world. Holds one world (editor or PIE) at a time.
+    TWeakObjectPtr<UWorld> ActorGuidIndexWorld;
+    TMap<FGuid, TWeakObjectPtr<AActor>> ActorByGuid;
+    bool bActorGuidIndexValid = false;
+
+    void BuildActorGuidIndex(UWorld* InWorld);
+    void InvalidateActorGuidIndex();
+    void OnLevelActorAddedOrDeleted(AActor* Actor);
+    void OnActorGuidIndexLevelChanged(ULevel* Level, UWorld* InWorld);
+
+    FDelegateHandle LevelActorAddedHandle;
+    FDelegateHandle LevelActorDeletedHandle;
+    FDelegateHandle GuidIndexLevelAddedHandle;
+    FDelegateHandle GuidIndexLevelRemovedHandle;
 
     static USkeletalMeshComponent* FindFirstSkeletalMeshComponent(AActor* Actor);
     static FString MakeDefaultAssetName(AActor* Actor);
@@ -301,12 +508,26 @@ private:
 
 
     void ProcessPendingAutoCaptures(int32 MaxPerTick);
+
+    /** True once Actor's first SkeletalMeshComponent has a mesh asset (spawned actors may get theirs later). */
+    static bool HasSkeletalMeshToCapture(AActor* Actor);
     bool TryAutoCaptureActor(AActor* Actor, const FMocapClassCaptureRule& Rule);
 
     void RequestStopForActor(AActor* Actor);
     void TickAutoStop(float DeltaTime);
+    void EvaluateAutoStopPolicies(float DeltaTime);
     APawn* GetPrimaryPlayerPawn() const;
-    bool IsOutOfPlayerRadius(AActor* Actor, float Radius) const;
+
+    // Parallel pose conversion (SampleAll)
+    void SampleRecorder(UMocapRecorderComponent* Recorder);
+    void CommitPendingPoses();
+
+    // BoneTransformsFinalized sampling
+    int64 GetSessionSampleIndexNow() const;
+    FDelegateHandle BindFinalizedSampling(USkeletalMeshComponent* SkelComp, UMocapRecorderComponent* Recorder);
+    static void UnbindFinalizedSampling(USkeletalMeshComponent* SkelComp, FDelegateHandle& Handle);
+    void HandleBoneTransformsFinalized(TWeakObjectPtr<UMocapRecorderComponent> WeakRecorder);
+    void OnWorldPostActorTick(UWorld* InWorld, ELevelTick TickType, float DeltaSeconds);
 
     // Baking control
     void MaybeBeginBakeQueue();
@@ -5,7 +5,7 @@
 DECLARE_LOG_CATEGORY_EXTERN(LogMocapRecorderEditor, Log, All);
 
 
-class UMocapRecorderComponent;
+struct FMocapRecordedTake;
 class UAnimSequence;
 class UMocapCaptureEditorSessionManager;
 
@@ -21,10 +21,10 @@ public:
     virtual void ShutdownModule() override;
 
 
-    // Bake an AnimSequence asset from a recorder component's captured frames.
-    // Returns the created AnimSequence or nullptr on failure.
-    static UAnimSequence* BakeAnimSequenceFromRecorder(
-        UMocapRecorderComponent* Recorder,
+    // Bake an AnimSequence asset from a take handed over by UMocapRecorderComponent::TransferRecordedTake.
+    // Raw captures are resolved in place first. Returns the created AnimSequence or nullptr on failure.
+    static UAnimSequence* BakeAnimSequenceFromTake(
+        FMocapRecordedTake& Recorded,
         const FString& AssetPath = TEXT("/Game/MocapCaptures"),
         const FString& OptionalAssetName = TEXT(""),
         int32 ExportFPS = 30